@@ -42,6 +42,11 @@ static struct BgControl sGpuBgConfigs;
 static struct BgConfig2 sGpuBgConfigs2[4];
 static u32 sDmaBusyBitfield[4];
 
+// Tile rows written through this file since each BG was last copied to VRAM.
+// Only meaningful for single-screen text mode BGs.
+EWRAM_DATA static u32 sBgTilemapDirtyRows[4] = {0};
+EWRAM_DATA static struct BgTilemapCopyStats sBgTilemapCopyStats = {0};
+
 u32 gUnneededFireRedVariable;
 
 static const struct BgConfig sZeroedBgControlStruct = { 0 };
@@ -855,6 +860,7 @@ void SetBgTilemapBuffer(u8 bg, void *tilemap)
     if (!IsInvalidBg32(bg) && GetBgControlAttribute(bg, BG_CTRL_ATTR_VISIBLE))
     {
         sGpuBgConfigs2[bg].tilemap = tilemap;
+        sBgTilemapDirtyRows[bg] = 0xFFFFFFFF;
     }
 }
 
@@ -880,9 +886,15 @@ void CopyToBgTilemapBuffer(u8 bg, const void *src, u16 mode, u16 destOffset)
     if (IsInvalidBg32(bg) || IsTileMapOutsideWram(bg))
         return;
     if (mode != 0)
+    {
         CpuCopy16(src, (void *)(sGpuBgConfigs2[bg].tilemap + (destOffset * 2)), mode);
+        MarkBgTilemapBufferRowsDirty(bg, destOffset / 32, (destOffset % 32 + mode / 2 + 31) / 32);
+    }
     else
+    {
         LZ77UnCompWram(src, (void *)(sGpuBgConfigs2[bg].tilemap + (destOffset * 2)));
+        MarkBgTilemapBufferRowsDirty(bg, 0, 32);
+    }
 }
 
 void CopyBgTilemapBufferToVram(u8 bg)
@@ -905,6 +917,94 @@ void CopyBgTilemapBufferToVram(u8 bg)
         break;
     }
     LoadBgVram(bg, sGpuBgConfigs2[bg].tilemap, sizeToLoad, 0, 2);
+    sBgTilemapDirtyRows[bg] = 0;
+    sBgTilemapCopyStats.bytesCopied += sizeToLoad;
+}
+
+// Like CopyBgTilemapBufferToVram, but only copies the rows changed since the
+// last copy. Writes made directly to the buffer rather than through this file
+// must be reported with MarkBgTilemapBufferRowsDirty, or they won't be copied.
+void CopyBgTilemapBufferDirtyRowsToVram(u8 bg)
+{
+    u32 dirtyRows, row, numRows, bytesCopied;
+
+    if (IsInvalidBg32(bg) || IsTileMapOutsideWram(bg))
+        return;
+
+    if (GetBgType(bg) != 0 || GetBgMetricTextMode(bg, 0) != 1)
+    {
+        CopyBgTilemapBufferToVram(bg);
+        return;
+    }
+
+    dirtyRows = sBgTilemapDirtyRows[bg];
+    sBgTilemapDirtyRows[bg] = 0;
+    bytesCopied = 0;
+    for (row = 0; row < 32; row++)
+    {
+        if (!((dirtyRows >> row) & 1))
+            continue;
+
+        for (numRows = 1; row + numRows < 32 && ((dirtyRows >> (row + numRows)) & 1); numRows++)
+            ;
+
+        CopyBgTilemapBufferRowsToVram(bg, row, numRows);
+        bytesCopied += numRows * 64;
+        row += numRows; // the row after a run is clean
+    }
+
+    sBgTilemapCopyStats.bytesCopied += bytesCopied;
+    sBgTilemapCopyStats.bytesSaved += BG_SCREEN_SIZE - bytesCopied;
+}
+
+// Rows wrap around, like the coordinates passed to the rect functions.
+void MarkBgTilemapBufferRowsDirty(u8 bg, u8 y, u16 height)
+{
+    u32 rows;
+
+    if (IsInvalidBg32(bg))
+        return;
+
+    if (height >= 32)
+    {
+        rows = 0xFFFFFFFF;
+    }
+    else
+    {
+        y %= 32;
+        rows = ((u32)1 << height) - 1;
+        rows = (rows << y) | (rows >> ((32 - y) % 32));
+    }
+    sBgTilemapDirtyRows[bg] |= rows;
+}
+
+// Returns the tilemap bytes copied and skipped since the previous call.
+void GetBgTilemapCopyStats(struct BgTilemapCopyStats *stats)
+{
+    *stats = sBgTilemapCopyStats;
+    sBgTilemapCopyStats.bytesCopied = 0;
+    sBgTilemapCopyStats.bytesSaved = 0;
+}
+
+// Copies only the given tile rows of a single-screen text mode tilemap.
+// Anything else is copied whole.
+void CopyBgTilemapBufferRowsToVram(u8 bg, u8 row, u8 numRows)
+{
+    if (IsInvalidBg32(bg) || IsTileMapOutsideWram(bg))
+        return;
+
+    if (GetBgType(bg) != 0 || GetBgMetricTextMode(bg, 0) != 1)
+    {
+        CopyBgTilemapBufferToVram(bg);
+        return;
+    }
+
+    if (row >= 32)
+        return;
+    if (row + numRows > 32)
+        numRows = 32 - row;
+
+    LoadBgVram(bg, (u16 *)sGpuBgConfigs2[bg].tilemap + row * 32, numRows * 64, row * 64, 2);
 }
 
 void CopyToBgTilemapBufferRect(u8 bg, const void *src, u8 destX, u8 destY, u8 width, u8 height)
@@ -914,6 +1014,7 @@ void CopyToBgTilemapBufferRect(u8 bg, const void *src, u8 destX, u8 destY, u8 wi
 
     if (IsInvalidBg32(bg) || IsTileMapOutsideWram(bg))
         return;
+    MarkBgTilemapBufferRowsDirty(bg, destY, height);
     switch (GetBgType(bg))
     {
     case 0:
@@ -961,6 +1062,9 @@ void CopyRectToBgTilemapBufferRect(u8 bg, const void *src, u8 srcX, u8 srcY, u8
         screenSize = GetBgControlAttribute(bg, BG_CTRL_ATTR_SCREENSIZE);
         screenWidth = GetBgMetricTextMode(bg, 0x1) * 0x20;
         screenHeight = GetBgMetricTextMode(bg, 0x2) * 0x20;
+        // The parameter names don't match their use: the rows written are
+        // destX to destX + rectWidth.
+        MarkBgTilemapBufferRowsDirty(bg, destX, rectWidth);
         switch (GetBgType(bg))
         {
         case 0:
@@ -1001,6 +1105,7 @@ void FillBgTilemapBufferRect_Palette0(u8 bg, u16 tileNum, u8 x, u8 y, u8 width,
 
     if (!IsInvalidBg32(bg) && !IsTileMapOutsideWram(bg))
     {
+        MarkBgTilemapBufferRowsDirty(bg, y, height);
         switch (GetBgType(bg))
         {
         case 0:
@@ -1044,6 +1149,7 @@ void WriteSequenceToBgTilemapBuffer(u8 bg, u16 firstTileNum, u8 x, u8 y, u8 widt
         attribute = GetBgControlAttribute(bg, BG_CTRL_ATTR_SCREENSIZE);
         mode = GetBgMetricTextMode(bg, 0x1) * 0x20;
         mode2 = GetBgMetricTextMode(bg, 0x2) * 0x20;
+        MarkBgTilemapBufferRowsDirty(bg, y, height);
         switch (GetBgType(bg))
         {
         case 0:
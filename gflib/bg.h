@@ -36,6 +36,12 @@ struct BgTemplate
     u16 baseTile:10;
 };
 
+struct BgTilemapCopyStats
+{
+    u32 bytesCopied;
+    u32 bytesSaved; // skipped by copying only dirty rows
+};
+
 void ResetBgs(void);
 u8 GetBgMode(void);
 void ResetBgControlStructs(void);
@@ -68,6 +74,10 @@ void UnsetBgTilemapBuffer(u8 bg);
 void* GetBgTilemapBuffer(u8 bg);
 void CopyToBgTilemapBuffer(u8 bg, const void *src, u16 mode, u16 destOffset);
 void CopyBgTilemapBufferToVram(u8 bg);
+void CopyBgTilemapBufferRowsToVram(u8 bg, u8 row, u8 numRows);
+void CopyBgTilemapBufferDirtyRowsToVram(u8 bg);
+void MarkBgTilemapBufferRowsDirty(u8 bg, u8 y, u16 height);
+void GetBgTilemapCopyStats(struct BgTilemapCopyStats *stats);
 void CopyToBgTilemapBufferRect(u8 bg, const void* src, u8 destX, u8 destY, u8 width, u8 height);
 void CopyToBgTilemapBufferRect_ChangePalette(u8 bg, const void *src, u8 destX, u8 destY, u8 rectWidth, u8 rectHeight, u8 palette);
 void CopyRectToBgTilemapBufferRect(u8 bg, const void *src, u8 srcX, u8 srcY, u8 srcWidth, u8 unused, u8 srcHeight, u8 destX, u8 destY, u8 rectWidth, u8 rectHeight, s16 palette1, s16 tileOffset);
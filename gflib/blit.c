@@ -6,10 +6,50 @@ void BlitBitmapRect4BitWithoutColorKey(const struct Bitmap *src, struct Bitmap *
     BlitBitmapRect4Bit(src, dst, srcX, srcY, dstX, dstY, width, height, 0xFF);
 }
 
-void BlitBitmapRect4Bit(const struct Bitmap *src, struct Bitmap *dst, u16 srcX, u16 srcY, u16 dstX, u16 dstY, u16 width, u16 height, u8 colorKey)
+// A 4bpp tile row is one word holding 8 pixels, the leftmost in the lowest
+// nibble. These mask the pixels from / up to a given column of that row.
+static const u32 sTileRowMaskFrom[8] =
+{
+    0xFFFFFFFF, 0xFFFFFFF0, 0xFFFFFF00, 0xFFFFF000,
+    0xFFFF0000, 0xFFF00000, 0xFF000000, 0xF0000000,
+};
+
+static const u32 sTileRowMaskTo[8] =
+{
+    0x0000000F, 0x000000FF, 0x00000FFF, 0x0000FFFF,
+    0x000FFFFF, 0x00FFFFFF, 0x0FFFFFFF, 0xFFFFFFFF,
+};
+
+// Returns the 8 pixels starting at pixel x of a bitmap row, where row points
+// at that row within the first tile column. Only the words holding pixels
+// selected by mask are read, so x may lie before the start of the row.
+static inline u32 ReadTileRow4Bit(const u8 *row, s32 x, u32 mask)
+{
+    u32 shift = (x & 7) << 2;
+    const u32 *words = (const u32 *)(row + ((x >> 3) << 5));
+    u32 pixels = 0;
+
+    if (shift == 0)
+        return *words;
+    if (mask & (0xFFFFFFFF >> shift))
+        pixels = *words >> shift;
+    if (mask & (0xFFFFFFFF << (32 - shift)))
+        pixels |= *(words + 8) << (32 - shift);
+    return pixels;
+}
+
+// Sets every nibble of the result that differs from colorKey.
+static inline u32 GetOpaqueMask4Bit(u32 pixels, u32 colorKey)
+{
+    u32 diff = pixels ^ (colorKey * 0x11111111);
+
+    diff |= diff >> 1;
+    diff |= diff >> 2;
+    return (diff & 0x11111111) * 0xF;
+}
+
+static void BlitBitmapRect4BitPerPixel(const struct Bitmap *src, struct Bitmap *dst, u16 srcX, u16 srcY, u16 dstX, u16 dstY, s32 xEnd, s32 yEnd, u8 colorKey)
 {
-    s32 xEnd;
-    s32 yEnd;
     s32 multiplierSrcY;
     s32 multiplierDstY;
     s32 loopSrcY, loopDstY;
@@ -20,28 +60,18 @@ void BlitBitmapRect4Bit(const struct Bitmap *src, struct Bitmap *dst, u16 srcX,
     s32 toAnd;
     s32 toShift;
 
-    if (dst->width - dstX < width)
-        xEnd = (dst->width - dstX) + srcX;
-    else
-        xEnd = srcX + width;
-
-    if (dst->height - dstY < height)
-        yEnd = (dst->height - dstY) + srcY;
-    else
-        yEnd = height + srcY;
-
     multiplierSrcY = (src->width + (src->width & 7)) >> 3;
     multiplierDstY = (dst->width + (dst->width & 7)) >> 3;
 
-    if (colorKey == 0xFF)
+    for (loopSrcY = srcY, loopDstY = dstY; loopSrcY < yEnd; loopSrcY++, loopDstY++)
     {
-        for (loopSrcY = srcY, loopDstY = dstY; loopSrcY < yEnd; loopSrcY++, loopDstY++)
+        for (loopSrcX = srcX, loopDstX = dstX; loopSrcX < xEnd; loopSrcX++, loopDstX++)
         {
-            for (loopSrcX = srcX, loopDstX = dstX; loopSrcX < xEnd; loopSrcX++, loopDstX++)
+            pixelsSrc = src->pixels + ((loopSrcX >> 1) & 3) + ((loopSrcX >> 3) << 5) + (((loopSrcY >> 3) * multiplierSrcY) << 5) + ((u32)(loopSrcY << 0x1d) >> 0x1B);
+            pixelsDst = dst->pixels + ((loopDstX >> 1) & 3) + ((loopDstX >> 3) << 5) + (((loopDstY >> 3) * multiplierDstY) << 5) + ((u32)(loopDstY << 0x1d) >> 0x1B);
+            toOrr = ((*pixelsSrc >> ((loopSrcX & 1) << 2)) & 0xF);
+            if (toOrr != colorKey)
             {
-                pixelsSrc = src->pixels + ((loopSrcX >> 1) & 3) + ((loopSrcX >> 3) << 5) + (((loopSrcY >> 3) * multiplierSrcY) << 5) + ((u32)(loopSrcY << 0x1d) >> 0x1B);
-                pixelsDst = dst->pixels + ((loopDstX >> 1) & 3) + ((loopDstX >> 3) << 5) + (((loopDstY >> 3) * multiplierDstY) << 5) + ((u32)(loopDstY << 0x1d) >> 0x1B);
-                toOrr = ((*pixelsSrc >> ((loopSrcX & 1) << 2)) & 0xF);
                 toShift = ((loopDstX & 1) << 2);
                 toOrr <<= toShift;
                 toAnd = 0xF0 >> (toShift);
@@ -49,23 +79,69 @@ void BlitBitmapRect4Bit(const struct Bitmap *src, struct Bitmap *dst, u16 srcX,
             }
         }
     }
+}
+
+// Works a tile row (8 pixels) at a time. Pixels outside the rect are masked off
+// at the edges, and with a color key the key's pixels are masked off too.
+void BlitBitmapRect4Bit(const struct Bitmap *src, struct Bitmap *dst, u16 srcX, u16 srcY, u16 dstX, u16 dstY, u16 width, u16 height, u8 colorKey)
+{
+    s32 xEnd;
+    s32 yEnd;
+    s32 multiplierSrcY;
+    s32 multiplierDstY;
+    s32 loopSrcY, loopDstY;
+    s32 dstXEnd;
+    s32 tileX, tileXEnd;
+    const u8 *rowSrc;
+    u8 *rowDst;
+    u32 *wordDst;
+    u32 pixels;
+    u32 mask;
+
+    if (dst->width - dstX < width)
+        xEnd = (dst->width - dstX) + srcX;
+    else
+        xEnd = srcX + width;
+
+    if (dst->height - dstY < height)
+        yEnd = (dst->height - dstY) + srcY;
     else
+        yEnd = height + srcY;
+
+    if (xEnd <= srcX || yEnd <= srcY)
+        return;
+
+    // Pixel data only has to be byte aligned.
+    if (((u32)src->pixels | (u32)dst->pixels) & 3)
     {
-        for (loopSrcY = srcY, loopDstY = dstY; loopSrcY < yEnd; loopSrcY++, loopDstY++)
+        BlitBitmapRect4BitPerPixel(src, dst, srcX, srcY, dstX, dstY, xEnd, yEnd, colorKey);
+        return;
+    }
+
+    multiplierSrcY = (src->width + (src->width & 7)) >> 3;
+    multiplierDstY = (dst->width + (dst->width & 7)) >> 3;
+    dstXEnd = dstX + (xEnd - srcX);
+    tileXEnd = (dstXEnd - 1) >> 3;
+
+    for (loopSrcY = srcY, loopDstY = dstY; loopSrcY < yEnd; loopSrcY++, loopDstY++)
+    {
+        rowSrc = src->pixels + (((loopSrcY >> 3) * multiplierSrcY) << 5) + ((loopSrcY & 7) << 2);
+        rowDst = dst->pixels + (((loopDstY >> 3) * multiplierDstY) << 5) + ((loopDstY & 7) << 2);
+
+        for (tileX = dstX >> 3; tileX <= tileXEnd; tileX++)
         {
-            for (loopSrcX = srcX, loopDstX = dstX; loopSrcX < xEnd; loopSrcX++, loopDstX++)
-            {
-                pixelsSrc = src->pixels + ((loopSrcX >> 1) & 3) + ((loopSrcX >> 3) << 5) + (((loopSrcY >> 3) * multiplierSrcY) << 5) + ((u32)(loopSrcY << 0x1d) >> 0x1B);
-                pixelsDst = dst->pixels + ((loopDstX >> 1) & 3) + ((loopDstX >> 3) << 5) + (((loopDstY >> 3) * multiplierDstY) << 5) + ((u32)(loopDstY << 0x1d) >> 0x1B);
-                toOrr = ((*pixelsSrc >> ((loopSrcX & 1) << 2)) & 0xF);
-                if (toOrr != colorKey)
-                {
-                    toShift = ((loopDstX & 1) << 2);
-                    toOrr <<= toShift;
-                    toAnd = 0xF0 >> (toShift);
-                    *pixelsDst = toOrr | (*pixelsDst & toAnd);
-                }
-            }
+            mask = 0xFFFFFFFF;
+            if (tileX == dstX >> 3)
+                mask &= sTileRowMaskFrom[dstX & 7];
+            if (tileX == tileXEnd)
+                mask &= sTileRowMaskTo[(dstXEnd - 1) & 7];
+
+            pixels = ReadTileRow4Bit(rowSrc, (tileX << 3) - dstX + srcX, mask);
+            if (colorKey < 16)
+                mask &= GetOpaqueMask4Bit(pixels, colorKey);
+
+            wordDst = (u32 *)(rowDst + (tileX << 5));
+            *wordDst = (*wordDst & ~mask) | (pixels & mask);
         }
     }
 }
@@ -76,7 +152,10 @@ void FillBitmapRect4Bit(struct Bitmap *surface, u16 x, u16 y, u16 width, u16 hei
     s32 yEnd;
     s32 multiplierY;
     s32 loopX, loopY;
-    s32 toOrr1, toOrr2;
+    s32 tileX, tileXEnd;
+    u32 *wordDst;
+    u32 fillValue32;
+    u32 mask;
 
     xEnd = x + width;
     if (xEnd > surface->width)
@@ -86,19 +165,47 @@ void FillBitmapRect4Bit(struct Bitmap *surface, u16 x, u16 y, u16 width, u16 hei
     if (yEnd > surface->height)
         yEnd = surface->height;
 
+    if (xEnd <= x || yEnd <= y)
+        return;
+
     multiplierY = (surface->width + (surface->width & 7)) >> 3;
-    toOrr1 = (u32)(fillValue << 0x1C) >> 0x18;
-    toOrr2 = (fillValue & 0xF);
+
+    if ((u32)surface->pixels & 3)
+    {
+        s32 toOrr1 = (u32)(fillValue << 0x1C) >> 0x18;
+        s32 toOrr2 = (fillValue & 0xF);
+
+        for (loopY = y; loopY < yEnd; loopY++)
+        {
+            for (loopX = x; loopX < xEnd; loopX++)
+            {
+                u8 *pixels = surface->pixels + ((loopX >> 1) & 3) + ((loopX >> 3) << 5) + (((loopY >> 3) * multiplierY) << 5) + ((u32)(loopY << 0x1d) >> 0x1B);
+                if ((loopX << 0x1F) != 0)
+                    *pixels = toOrr1 | (*pixels & 0xF);
+                else
+                    *pixels = toOrr2 | (*pixels & 0xF0);
+            }
+        }
+        return;
+    }
+
+    fillValue32 = (u32)(fillValue & 0xF) * 0x11111111;
+    tileXEnd = (xEnd - 1) >> 3;
 
     for (loopY = y; loopY < yEnd; loopY++)
     {
-        for (loopX = x; loopX < xEnd; loopX++)
+        u8 *row = surface->pixels + (((loopY >> 3) * multiplierY) << 5) + ((loopY & 7) << 2);
+
+        for (tileX = x >> 3; tileX <= tileXEnd; tileX++)
         {
-            u8 *pixels = surface->pixels + ((loopX >> 1) & 3) + ((loopX >> 3) << 5) + (((loopY >> 3) * multiplierY) << 5) + ((u32)(loopY << 0x1d) >> 0x1B);
-            if ((loopX << 0x1F) != 0)
-                *pixels = toOrr1 | (*pixels & 0xF);
-            else
-                *pixels = toOrr2 | (*pixels & 0xF0);
+            mask = 0xFFFFFFFF;
+            if (tileX == x >> 3)
+                mask &= sTileRowMaskFrom[x & 7];
+            if (tileX == tileXEnd)
+                mask &= sTileRowMaskTo[(xEnd - 1) & 7];
+
+            wordDst = (u32 *)(row + (tileX << 5));
+            *wordDst = (*wordDst & ~mask) | (fillValue32 & mask);
         }
     }
 }
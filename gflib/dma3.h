@@ -46,10 +46,23 @@
 #define Dma3FillLarge16_(value, dest, size) Dma3FillLarge_(value, dest, size, 16)
 #define Dma3FillLarge32_(value, dest, size) Dma3FillLarge_(value, dest, size, 32)
 
+#define DMA3_PRIORITY_NORMAL 0
+#define DMA3_PRIORITY_HIGH   1 // small, latency-sensitive updates like cursors and palettes
+
+struct Dma3Stats
+{
+    u32 bytesQueued;  // requested since the previous frame
+    u32 bytesFlushed; // actually transferred
+    u16 numDeferred;  // requests left over for the next frame
+    u16 numMerged;    // requests folded into one already queued
+};
+
 void ClearDma3Requests(void);
 void ProcessDma3Requests(void);
 s16 RequestDma3Copy(const void *src, void *dest, u16 size, u8 mode);
+s16 RequestDma3CopyWithPriority(const void *src, void *dest, u16 size, u8 mode, u8 priority);
 s16 RequestDma3Fill(s32 value, void *dest, u16 size, u8 mode);
 s16 CheckForSpaceForDma3Request(s16 index);
+void GetDma3Stats(struct Dma3Stats *stats);
 
 #endif // GUARD_DMA3_H
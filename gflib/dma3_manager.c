@@ -7,19 +7,27 @@
 #define DMA_REQUEST_FILL32 2
 #define DMA_REQUEST_COPY16 3
 #define DMA_REQUEST_FILL16 4
+#define DMA_REQUEST_DONE   5 // already run ahead of its turn, so it's just freed
+
+#define MAX_DMA_BYTES_PER_FRAME (40 * 1024)
 
 BSS_DATA struct
 {
     const u8 *src;
     u8 *dest;
     u16 size;
-    u16 mode;
+    u8 mode;
+    u8 priority;
     u32 value;
 } gDma3Requests[MAX_DMA_REQUESTS];
 
 static volatile bool8 gDma3ManagerLocked;
 static u8 gDma3RequestCursor;
 
+EWRAM_DATA static struct Dma3Stats sDma3Stats = {0};
+EWRAM_DATA static u32 sDma3BytesQueued = 0;
+EWRAM_DATA static u16 sDma3NumMerged = 0;
+
 void ClearDma3Requests(void)
 {
     int i;
@@ -37,47 +45,126 @@ void ClearDma3Requests(void)
     gDma3ManagerLocked = FALSE;
 }
 
+static bool32 IsDma3Copy(u8 mode)
+{
+    return mode == DMA_REQUEST_COPY32 || mode == DMA_REQUEST_COPY16;
+}
+
+static bool32 RangesOverlap(const u8 *a, u32 aSize, const u8 *b, u32 bSize)
+{
+    return a < b + bSize && b < a + aSize;
+}
+
+// Whether the two requests would have a different effect if run the other
+// way around: one writes memory that the other reads or writes.
+static bool32 Dma3RequestsConflict(int a, int b)
+{
+    if (RangesOverlap(gDma3Requests[a].dest, gDma3Requests[a].size, gDma3Requests[b].dest, gDma3Requests[b].size))
+        return TRUE;
+    if (IsDma3Copy(gDma3Requests[a].mode)
+     && RangesOverlap(gDma3Requests[a].src, gDma3Requests[a].size, gDma3Requests[b].dest, gDma3Requests[b].size))
+        return TRUE;
+    if (IsDma3Copy(gDma3Requests[b].mode)
+     && RangesOverlap(gDma3Requests[b].src, gDma3Requests[b].size, gDma3Requests[a].dest, gDma3Requests[a].size))
+        return TRUE;
+    return FALSE;
+}
+
+static bool32 Dma3RequestConflictsWithEarlier(int cursor)
+{
+    int i = gDma3RequestCursor;
+
+    while (i != cursor)
+    {
+        if (gDma3Requests[i].mode != DMA_REQUEST_DONE && Dma3RequestsConflict(i, cursor))
+            return TRUE;
+        if (++i >= MAX_DMA_REQUESTS)
+            i = 0;
+    }
+
+    return FALSE;
+}
+
+static void RunDma3Request(int cursor)
+{
+    switch (gDma3Requests[cursor].mode)
+    {
+    case DMA_REQUEST_COPY32: // regular 32-bit copy
+        Dma3CopyLarge32_(gDma3Requests[cursor].src,
+                         gDma3Requests[cursor].dest,
+                         gDma3Requests[cursor].size);
+        break;
+    case DMA_REQUEST_FILL32: // repeat a single 32-bit value across RAM
+        Dma3FillLarge32_(gDma3Requests[cursor].value,
+                         gDma3Requests[cursor].dest,
+                         gDma3Requests[cursor].size);
+        break;
+    case DMA_REQUEST_COPY16:    // regular 16-bit copy
+        Dma3CopyLarge16_(gDma3Requests[cursor].src,
+                         gDma3Requests[cursor].dest,
+                         gDma3Requests[cursor].size);
+        break;
+    case DMA_REQUEST_FILL16: // repeat a single 16-bit value across RAM
+        Dma3FillLarge16_(gDma3Requests[cursor].value,
+                         gDma3Requests[cursor].dest,
+                         gDma3Requests[cursor].size);
+        break;
+    }
+}
+
 void ProcessDma3Requests(void)
 {
     u16 bytesTransferred;
+    u32 bytesFlushed;
+    int cursor;
+    int i;
 
     if (gDma3ManagerLocked)
         return;
 
     bytesTransferred = 0;
+    bytesFlushed = 0;
+
+    // High priority requests go first, so that bulky uploads queued before
+    // them can't push them into the next frame. One is only run early if
+    // nothing queued before it touches the same memory, so the end result is
+    // the same as running the queue in order.
+    cursor = gDma3RequestCursor;
+    for (i = 0; i < MAX_DMA_REQUESTS && gDma3Requests[cursor].size != 0; i++)
+    {
+        if (gDma3Requests[cursor].priority == DMA3_PRIORITY_HIGH
+         && gDma3Requests[cursor].mode != DMA_REQUEST_DONE
+         && !Dma3RequestConflictsWithEarlier(cursor))
+        {
+            if (bytesTransferred + gDma3Requests[cursor].size > MAX_DMA_BYTES_PER_FRAME)
+                break;
+            if (*(u8 *)REG_ADDR_VCOUNT > 224)
+                break;
+
+            bytesTransferred += gDma3Requests[cursor].size;
+            bytesFlushed += gDma3Requests[cursor].size;
+            RunDma3Request(cursor);
+            gDma3Requests[cursor].mode = DMA_REQUEST_DONE;
+        }
+
+        if (++cursor >= MAX_DMA_REQUESTS)
+            cursor = 0;
+    }
 
     // as long as there are DMA requests to process (unless size or vblank is an issue), do not exit
     while (gDma3Requests[gDma3RequestCursor].size != 0)
     {
-        bytesTransferred += gDma3Requests[gDma3RequestCursor].size;
+        if (gDma3Requests[gDma3RequestCursor].mode != DMA_REQUEST_DONE)
+        {
+            bytesTransferred += gDma3Requests[gDma3RequestCursor].size;
 
-        if (bytesTransferred > 40 * 1024)
-            return; // don't transfer more than 40 KiB
-        if (*(u8 *)REG_ADDR_VCOUNT > 224)
-            return; // we're about to leave vblank, stop
+            if (bytesTransferred > MAX_DMA_BYTES_PER_FRAME)
+                break; // don't transfer more than 40 KiB
+            if (*(u8 *)REG_ADDR_VCOUNT > 224)
+                break; // we're about to leave vblank, stop
 
-        switch (gDma3Requests[gDma3RequestCursor].mode)
-        {
-        case DMA_REQUEST_COPY32: // regular 32-bit copy
-            Dma3CopyLarge32_(gDma3Requests[gDma3RequestCursor].src,
-                             gDma3Requests[gDma3RequestCursor].dest,
-                             gDma3Requests[gDma3RequestCursor].size);
-            break;
-        case DMA_REQUEST_FILL32: // repeat a single 32-bit value across RAM
-            Dma3FillLarge32_(gDma3Requests[gDma3RequestCursor].value,
-                             gDma3Requests[gDma3RequestCursor].dest,
-                             gDma3Requests[gDma3RequestCursor].size);
-            break;
-        case DMA_REQUEST_COPY16:    // regular 16-bit copy
-            Dma3CopyLarge16_(gDma3Requests[gDma3RequestCursor].src,
-                             gDma3Requests[gDma3RequestCursor].dest,
-                             gDma3Requests[gDma3RequestCursor].size);
-            break;
-        case DMA_REQUEST_FILL16: // repeat a single 16-bit value across RAM
-            Dma3FillLarge16_(gDma3Requests[gDma3RequestCursor].value,
-                             gDma3Requests[gDma3RequestCursor].dest,
-                             gDma3Requests[gDma3RequestCursor].size);
-            break;
+            bytesFlushed += gDma3Requests[gDma3RequestCursor].size;
+            RunDma3Request(gDma3RequestCursor);
         }
 
         // Free the request
@@ -85,67 +172,120 @@ void ProcessDma3Requests(void)
         gDma3Requests[gDma3RequestCursor].dest = NULL;
         gDma3Requests[gDma3RequestCursor].size = 0;
         gDma3Requests[gDma3RequestCursor].mode = 0;
+        gDma3Requests[gDma3RequestCursor].priority = 0;
         gDma3Requests[gDma3RequestCursor].value = 0;
         gDma3RequestCursor++;
 
         if (gDma3RequestCursor >= MAX_DMA_REQUESTS) // loop back to the first DMA request
             gDma3RequestCursor = 0;
     }
+
+    sDma3Stats.bytesQueued = sDma3BytesQueued;
+    sDma3Stats.bytesFlushed = bytesFlushed;
+    sDma3Stats.numMerged = sDma3NumMerged;
+    sDma3Stats.numDeferred = 0;
+    cursor = gDma3RequestCursor;
+    for (i = 0; i < MAX_DMA_REQUESTS && gDma3Requests[cursor].size != 0; i++)
+    {
+        if (gDma3Requests[cursor].mode != DMA_REQUEST_DONE)
+            sDma3Stats.numDeferred++;
+        if (++cursor >= MAX_DMA_REQUESTS)
+            cursor = 0;
+    }
+    sDma3BytesQueued = 0;
+    sDma3NumMerged = 0;
 }
 
-s16 RequestDma3Copy(const void *src, void *dest, u16 size, u8 mode)
+// Tries to fold a new request (already written to the free slot at `cursor`)
+// into one that is still queued, and returns that one's index, or -1.
+// A request that writes exactly where a queued one does replaces it, which
+// also drops duplicates of requests made every frame. A copy or fill that
+// carries on where the last queued one ends is appended to it. Neither is
+// done past a queued request that touches the same memory, since that would
+// change the order the two happen in.
+static s16 FoldDma3Request(int cursor)
 {
-    int cursor;
-    int i = 0;
+    int i = cursor;
+    bool32 isLast = TRUE;
 
-    gDma3ManagerLocked = TRUE;
-    cursor = gDma3RequestCursor;
+    if (gDma3Requests[cursor].size == 0)
+        return -1;
 
-    while (i < MAX_DMA_REQUESTS)
+    while (i != gDma3RequestCursor)
     {
-        if (gDma3Requests[cursor].size == 0) // an empty request was found.
+        if (--i < 0)
+            i = MAX_DMA_REQUESTS - 1;
+
+        if (gDma3Requests[i].mode != DMA_REQUEST_DONE)
         {
-            gDma3Requests[cursor].src = src;
-            gDma3Requests[cursor].dest = dest;
-            gDma3Requests[cursor].size = size;
+            if (gDma3Requests[i].dest == gDma3Requests[cursor].dest
+             && gDma3Requests[i].size == gDma3Requests[cursor].size)
+            {
+                gDma3Requests[i].src = gDma3Requests[cursor].src;
+                gDma3Requests[i].mode = gDma3Requests[cursor].mode;
+                gDma3Requests[i].value = gDma3Requests[cursor].value;
+                if (gDma3Requests[cursor].priority > gDma3Requests[i].priority)
+                    gDma3Requests[i].priority = gDma3Requests[cursor].priority;
+                return i;
+            }
 
-            if (mode == 1)
-                gDma3Requests[cursor].mode = DMA_REQUEST_COPY32;
-            else
-                gDma3Requests[cursor].mode = DMA_REQUEST_COPY16;
+            if (isLast
+             && gDma3Requests[i].mode == gDma3Requests[cursor].mode
+             && gDma3Requests[i].priority == gDma3Requests[cursor].priority
+             && (gDma3Requests[i].size & 3) == 0
+             && gDma3Requests[i].size + gDma3Requests[cursor].size <= MAX_DMA_BYTES_PER_FRAME
+             && gDma3Requests[i].dest + gDma3Requests[i].size == gDma3Requests[cursor].dest
+             && (IsDma3Copy(gDma3Requests[i].mode)
+               ? gDma3Requests[i].src + gDma3Requests[i].size == gDma3Requests[cursor].src
+               : gDma3Requests[i].value == gDma3Requests[cursor].value))
+            {
+                gDma3Requests[i].size += gDma3Requests[cursor].size;
+                return i;
+            }
 
-            gDma3ManagerLocked = FALSE;
-            return cursor;
+            if (Dma3RequestsConflict(i, cursor))
+                return -1;
+
+            isLast = FALSE;
         }
-        if (++cursor >= MAX_DMA_REQUESTS) // loop back to start.
-            cursor = 0;
-        i++;
     }
-    gDma3ManagerLocked = FALSE;
-    return -1;  // no free DMA request was found
+
+    return -1;
 }
 
-s16 RequestDma3Fill(s32 value, void *dest, u16 size, u8 mode)
+static s16 AddDma3Request(const void *src, u32 value, void *dest, u16 size, u8 mode, u8 priority)
 {
     int cursor;
     int i = 0;
+    s16 folded;
 
-    cursor = gDma3RequestCursor;
     gDma3ManagerLocked = TRUE;
+    cursor = gDma3RequestCursor;
+    sDma3BytesQueued += size;
 
     while (i < MAX_DMA_REQUESTS)
     {
         if (gDma3Requests[cursor].size == 0) // an empty request was found.
         {
+            gDma3Requests[cursor].src = src;
             gDma3Requests[cursor].dest = dest;
             gDma3Requests[cursor].size = size;
             gDma3Requests[cursor].mode = mode;
+            gDma3Requests[cursor].priority = priority;
             gDma3Requests[cursor].value = value;
 
-            if(mode == 1)
-                gDma3Requests[cursor].mode = DMA_REQUEST_FILL32;
-            else
-                gDma3Requests[cursor].mode = DMA_REQUEST_FILL16;
+            folded = FoldDma3Request(cursor);
+            if (folded != -1)
+            {
+                gDma3Requests[cursor].src = NULL;
+                gDma3Requests[cursor].dest = NULL;
+                gDma3Requests[cursor].size = 0;
+                gDma3Requests[cursor].mode = 0;
+                gDma3Requests[cursor].priority = 0;
+                gDma3Requests[cursor].value = 0;
+                sDma3NumMerged++;
+                cursor = folded;
+            }
 
             gDma3ManagerLocked = FALSE;
             return cursor;
@@ -158,6 +298,27 @@ s16 RequestDma3Fill(s32 value, void *dest, u16 size, u8 mode)
     return -1;  // no free DMA request was found
 }
 
+s16 RequestDma3Copy(const void *src, void *dest, u16 size, u8 mode)
+{
+    return RequestDma3CopyWithPriority(src, dest, size, mode, DMA3_PRIORITY_NORMAL);
+}
+
+s16 RequestDma3CopyWithPriority(const void *src, void *dest, u16 size, u8 mode, u8 priority)
+{
+    if (mode == 1)
+        return AddDma3Request(src, 0, dest, size, DMA_REQUEST_COPY32, priority);
+    else
+        return AddDma3Request(src, 0, dest, size, DMA_REQUEST_COPY16, priority);
+}
+
+s16 RequestDma3Fill(s32 value, void *dest, u16 size, u8 mode)
+{
+    if (mode == 1)
+        return AddDma3Request(NULL, value, dest, size, DMA_REQUEST_FILL32, DMA3_PRIORITY_NORMAL);
+    else
+        return AddDma3Request(NULL, value, dest, size, DMA_REQUEST_FILL16, DMA3_PRIORITY_NORMAL);
+}
+
 s16 CheckForSpaceForDma3Request(s16 index)
 {
     int i = 0;
@@ -179,3 +340,9 @@ s16 CheckForSpaceForDma3Request(s16 index)
         return 0;
     }
 }
+
+// Reports on the last ProcessDma3Requests call.
+void GetDma3Stats(struct Dma3Stats *stats)
+{
+    *stats = sDma3Stats;
+}
@@ -1,4 +1,7 @@
 #include "global.h"
+#include "malloc.h"
+#include "main.h"
+#include "util.h"
 
 static void *sHeapStart;
 static u32 sHeapSize;
@@ -22,10 +25,140 @@ struct MemBlock {
     // Next block pointer. Equals sHeapStart if this is the last block.
     struct MemBlock *next;
 
+#if DEBUG
+    // Return address of the Alloc call that handed out this block, the main
+    // callback that was running and the epoch it ran in. See CheckHeapLeaks.
+    const void *caller;
+    const void *owner;
+    u32 epoch;
+#endif
+
     // Data in the memory block. (Arrays of length 0 are a GNU extension.)
     u8 data[0];
 };
 
+// Free blocks are additionally kept in size-segregated free lists, so that
+// allocation doesn't have to walk every block in the heap. Bin n holds free
+// blocks whose size is in [16 << (n - 1), 16 << n), with bin 0 holding the
+// smallest ones and the last bin everything too big for the others.
+#define NUM_FREE_BINS 16
+
+// The free list links live in the data of free blocks, so every block must be
+// able to hold them.
+#define MIN_BLOCK_SIZE 8
+
+struct FreeLinks {
+    struct MemBlock *prev;
+    struct MemBlock *next;
+};
+
+#define FREE_LINKS(block) ((struct FreeLinks *)(block)->data)
+
+static struct MemBlock *sFreeBins[NUM_FREE_BINS];
+static u32 sFreeBinBitmap;
+
+#if DEBUG
+EWRAM_DATA static struct HeapEvent sHeapLog[HEAP_LOG_LENGTH] = {0};
+EWRAM_DATA static u32 sHeapLogCount = 0;
+EWRAM_DATA static u32 sHeapLiveBytes = 0;
+EWRAM_DATA static u32 sHeapPeakLiveBytes = 0;
+EWRAM_DATA static u32 sHeapLiveBlocks = 0;
+EWRAM_DATA static u32 sHeapEpoch = 0;
+
+// The main callbacks left since the oldest one still kept, most recent last.
+#define HEAP_SCREEN_HISTORY_LENGTH 16
+
+// Blocks are moved to this epoch once reported, so they're only reported once.
+#define HEAP_EPOCH_REPORTED 0xFFFFFFFF
+
+struct HeapScreen {
+    const void *callback;
+    u32 epoch;
+    u32 frames;
+};
+
+EWRAM_DATA static struct HeapScreen sHeapScreens[HEAP_SCREEN_HISTORY_LENGTH] = {0};
+EWRAM_DATA static u32 sHeapScreenCount = 0;
+EWRAM_DATA static u32 sHeapScreenStartFrame = 0;
+EWRAM_DATA static struct HeapLeak sHeapLeaks[HEAP_LEAK_LIST_LENGTH] = {0};
+EWRAM_DATA static u32 sHeapLeakCount = 0;
+
+static void RecordAlloc(void *mem, u32 size, const void *caller);
+static void RecordFree(void *pointer, const void *caller);
+
+#define RECORD_ALLOC(mem, size) RecordAlloc(mem, size, __builtin_return_address(0))
+#define RECORD_FREE(pointer) RecordFree(pointer, __builtin_return_address(0))
+#else
+#define RECORD_ALLOC(mem, size)
+#define RECORD_FREE(pointer)
+#endif
+
+static u32 GetFreeBin(u32 size)
+{
+    u32 bin = 0;
+
+    size >>= 4;
+    while (size != 0 && bin < NUM_FREE_BINS - 1)
+    {
+        size >>= 1;
+        bin++;
+    }
+
+    return bin;
+}
+
+static void InsertFreeBlock(struct MemBlock *block)
+{
+    u32 bin = GetFreeBin(block->size);
+    struct MemBlock *first = sFreeBins[bin];
+
+    FREE_LINKS(block)->prev = NULL;
+    FREE_LINKS(block)->next = first;
+    if (first != NULL)
+        FREE_LINKS(first)->prev = block;
+
+    sFreeBins[bin] = block;
+    sFreeBinBitmap |= 1 << bin;
+}
+
+static void RemoveFreeBlock(struct MemBlock *block)
+{
+    struct FreeLinks *links = FREE_LINKS(block);
+
+    if (links->next != NULL)
+        FREE_LINKS(links->next)->prev = links->prev;
+
+    if (links->prev != NULL)
+    {
+        FREE_LINKS(links->prev)->next = links->next;
+    }
+    else
+    {
+        u32 bin = GetFreeBin(block->size);
+
+        sFreeBins[bin] = links->next;
+        if (links->next == NULL)
+            sFreeBinBitmap &= ~(1 << bin);
+    }
+}
+
+static struct MemBlock *FindBestFit(struct MemBlock *block, u32 size)
+{
+    struct MemBlock *best = NULL;
+
+    for (; block != NULL; block = FREE_LINKS(block)->next)
+    {
+        if (block->size >= size && (best == NULL || block->size < best->size))
+        {
+            best = block;
+            if (block->size == size)
+                break;
+        }
+    }
+
+    return best;
+}
+
 void PutMemBlockHeader(void *block, struct MemBlock *prev, struct MemBlock *next, u32 size)
 {
     struct MemBlock *header = (struct MemBlock *)block;
@@ -44,54 +177,63 @@ void PutFirstMemBlockHeader(void *block, u32 size)
 
 void *AllocInternal(void *heapStart, u32 size)
 {
-    struct MemBlock *pos = (struct MemBlock *)heapStart;
-    struct MemBlock *head = pos;
+    struct MemBlock *head = (struct MemBlock *)heapStart;
+    struct MemBlock *pos;
     struct MemBlock *splitBlock;
     u32 foundBlockSize;
+    u32 bin, largerBins;
 
     // Alignment
     if (size & 3)
         size = 4 * ((size / 4) + 1);
+    if (size < MIN_BLOCK_SIZE)
+        size = MIN_BLOCK_SIZE;
+
+    // Blocks in the request's own bin may be too small, so take the best fit
+    // among those. Otherwise any block in the next non-empty bin is big enough,
+    // and the best fit there is taken to limit fragmentation.
+    bin = GetFreeBin(size);
+    pos = FindBestFit(sFreeBins[bin], size);
+
+    if (pos == NULL)
+    {
+        largerBins = sFreeBinBitmap & ~((2 << bin) - 1);
+        if (largerBins == 0)
+            return NULL;
+        pos = FindBestFit(sFreeBins[CountTrailingZeroBits(largerBins)], size);
+    }
 
-    for (;;) {
-        // Loop through the blocks looking for unused block that's big enough.
-
-        if (!pos->flag) {
-            foundBlockSize = pos->size;
-
-            if (foundBlockSize >= size) {
-                if (foundBlockSize - size < 2 * sizeof(struct MemBlock)) {
-                    // The block isn't much bigger than the requested size,
-                    // so just use it.
-                    pos->flag = TRUE;
-                } else {
-                    // The block is significantly bigger than the requested
-                    // size, so split the rest into a separate block.
-                    foundBlockSize -= sizeof(struct MemBlock);
-                    foundBlockSize -= size;
+    RemoveFreeBlock(pos);
+    foundBlockSize = pos->size;
 
-                    splitBlock = (struct MemBlock *)(pos->data + size);
+    if (foundBlockSize - size < 2 * sizeof(struct MemBlock)) {
+        // The block isn't much bigger than the requested size,
+        // so just use it.
+        pos->flag = TRUE;
+    } else {
+        // The block is significantly bigger than the requested
+        // size, so split the rest into a separate block.
+        foundBlockSize -= sizeof(struct MemBlock);
+        foundBlockSize -= size;
 
-                    pos->flag = TRUE;
-                    pos->size = size;
+        splitBlock = (struct MemBlock *)(pos->data + size);
 
-                    PutMemBlockHeader(splitBlock, pos, pos->next, foundBlockSize);
+        pos->flag = TRUE;
+        pos->size = size;
 
-                    pos->next = splitBlock;
+        PutMemBlockHeader(splitBlock, pos, pos->next, foundBlockSize);
 
-                    if (splitBlock->next != head)
-                        splitBlock->next->prev = splitBlock;
-                }
+        pos->next = splitBlock;
 
-                return pos->data;
-            }
-        }
+        if (splitBlock->next != head)
+            splitBlock->next->prev = splitBlock;
 
-        if (pos->next == head)
-            return NULL;
-
-        pos = pos->next;
+        // Free blocks are always coalesced, so the block after a free one is
+        // in use and the split-off part can't be merged with anything.
+        InsertFreeBlock(splitBlock);
     }
+
+    return pos->data;
 }
 
 void FreeInternal(void *heapStart, void *pointer)
@@ -105,6 +247,7 @@ void FreeInternal(void *heapStart, void *pointer)
         // if it's not in use.
         if (block->next != head) {
             if (!block->next->flag) {
+                RemoveFreeBlock(block->next);
                 block->size += sizeof(struct MemBlock) + block->next->size;
                 block->next->magic = 0;
                 block->next = block->next->next;
@@ -117,6 +260,7 @@ void FreeInternal(void *heapStart, void *pointer)
         // if it's not in use.
         if (block != head) {
             if (!block->prev->flag) {
+                RemoveFreeBlock(block->prev);
                 block->prev->next = block->next;
 
                 if (block->next != head)
@@ -124,8 +268,11 @@ void FreeInternal(void *heapStart, void *pointer)
 
                 block->magic = 0;
                 block->prev->size += sizeof(struct MemBlock) + block->size;
+                block = block->prev;
             }
         }
+
+        InsertFreeBlock(block);
     }
 }
 
@@ -171,23 +318,46 @@ bool32 CheckMemBlockInternal(void *heapStart, void *pointer)
 
 void InitHeap(void *heapStart, u32 heapSize)
 {
+    u32 i;
+
     sHeapStart = heapStart;
     sHeapSize = heapSize;
     PutFirstMemBlockHeader(heapStart, heapSize);
+
+    for (i = 0; i < NUM_FREE_BINS; i++)
+        sFreeBins[i] = NULL;
+    sFreeBinBitmap = 0;
+    InsertFreeBlock((struct MemBlock *)heapStart);
+
+#if DEBUG
+    sHeapLogCount = 0;
+    sHeapLiveBytes = 0;
+    sHeapPeakLiveBytes = 0;
+    sHeapLiveBlocks = 0;
+    sHeapScreenCount = 0;
+    sHeapLeakCount = 0;
+#endif
 }
 
 void *Alloc(u32 size)
 {
-    return AllocInternal(sHeapStart, size);
+    void *mem = AllocInternal(sHeapStart, size);
+
+    RECORD_ALLOC(mem, size);
+    return mem;
 }
 
 void *AllocZeroed(u32 size)
 {
-    return AllocZeroedInternal(sHeapStart, size);
+    void *mem = AllocZeroedInternal(sHeapStart, size);
+
+    RECORD_ALLOC(mem, size);
+    return mem;
 }
 
 void Free(void *pointer)
 {
+    RECORD_FREE(pointer);
     FreeInternal(sHeapStart, pointer);
 }
 
@@ -196,6 +366,53 @@ bool32 CheckMemBlock(void *pointer)
     return CheckMemBlockInternal(sHeapStart, pointer);
 }
 
+// Arenas reserve a single heap block up front and hand out pieces of it with
+// a bump pointer. Screens that allocate many buffers on init and free them all
+// on exit can use one instead of pairing every AllocZeroed with a Free, and
+// release everything at once with ArenaReset.
+bool32 ArenaBegin(struct Arena *arena, u32 size)
+{
+    if (size & 3)
+        size = 4 * ((size / 4) + 1);
+
+    arena->start = AllocInternal(sHeapStart, size);
+    RECORD_ALLOC(arena->start, size);
+    arena->size = arena->start != NULL ? size : 0;
+    arena->used = 0;
+
+    return arena->start != NULL;
+}
+
+// Returns zeroed memory like AllocZeroed, or NULL if the arena is full.
+void *ArenaAlloc(struct Arena *arena, u32 size)
+{
+    void *mem;
+
+    if (size & 3)
+        size = 4 * ((size / 4) + 1);
+
+    if (arena->start == NULL || size > arena->size - arena->used)
+        return NULL;
+
+    mem = arena->start + arena->used;
+    arena->used += size;
+
+    if (size != 0)
+        CpuFill32(0, mem, size);
+
+    return mem;
+}
+
+// Returns the arena's block to the heap, invalidating everything allocated from it.
+void ArenaReset(struct Arena *arena)
+{
+    RECORD_FREE(arena->start);
+    FreeInternal(sHeapStart, arena->start);
+    arena->start = NULL;
+    arena->size = 0;
+    arena->used = 0;
+}
+
 bool32 CheckHeap()
 {
     struct MemBlock *pos = (struct MemBlock *)sHeapStart;
@@ -208,3 +425,182 @@ bool32 CheckHeap()
 
     return TRUE;
 }
+
+#if DEBUG
+
+// Heap instrumentation. Every Alloc, AllocZeroed and Free goes into a ring
+// buffer along with its caller, and allocated blocks remember which main
+// callback they were made in so that blocks outliving their screen can be
+// listed. The debug menu's heap viewer reads all of this.
+
+static void LogHeapEvent(u8 type, void *pointer, u32 size, const void *caller)
+{
+    struct HeapEvent *event = &sHeapLog[sHeapLogCount % HEAP_LOG_LENGTH];
+
+    event->caller = caller;
+    event->pointer = pointer;
+    event->size = size;
+    event->type = type;
+    sHeapLogCount++;
+}
+
+static void RecordAlloc(void *mem, u32 size, const void *caller)
+{
+    struct MemBlock *block;
+
+    if (mem == NULL)
+    {
+        LogHeapEvent(HEAP_EVENT_FAIL, NULL, size, caller);
+        return;
+    }
+
+    block = (struct MemBlock *)((u8 *)mem - sizeof(struct MemBlock));
+    block->caller = caller;
+    block->owner = gMain.callback2;
+    block->epoch = sHeapEpoch;
+
+    sHeapLiveBytes += block->size;
+    sHeapLiveBlocks++;
+    if (sHeapLiveBytes > sHeapPeakLiveBytes)
+        sHeapPeakLiveBytes = sHeapLiveBytes;
+
+    LogHeapEvent(HEAP_EVENT_ALLOC, mem, size, caller);
+}
+
+static void RecordFree(void *pointer, const void *caller)
+{
+    struct MemBlock *block;
+
+    if (pointer == NULL)
+        return;
+
+    block = (struct MemBlock *)((u8 *)pointer - sizeof(struct MemBlock));
+    sHeapLiveBytes -= block->size;
+    sHeapLiveBlocks--;
+
+    LogHeapEvent(HEAP_EVENT_FREE, pointer, block->size, caller);
+}
+
+void GetHeapStats(struct HeapStats *stats)
+{
+    struct MemBlock *block;
+    u32 bin;
+
+    stats->liveBytes = sHeapLiveBytes;
+    stats->peakLiveBytes = sHeapPeakLiveBytes;
+    stats->liveBlocks = sHeapLiveBlocks;
+    stats->freeBytes = 0;
+    stats->largestFreeBlock = 0;
+
+    for (bin = 0; bin < NUM_FREE_BINS; bin++)
+    {
+        for (block = sFreeBins[bin]; block != NULL; block = FREE_LINKS(block)->next)
+        {
+            stats->freeBytes += block->size;
+            if (block->size > stats->largestFreeBlock)
+                stats->largestFreeBlock = block->size;
+        }
+    }
+
+    if (stats->freeBytes != 0)
+        stats->fragmentation = 100 - (stats->largestFreeBlock * 100) / stats->freeBytes;
+    else
+        stats->fragmentation = 0;
+}
+
+// Returns the logged event that happened `age` events ago (0 being the most
+// recent), or NULL if it has dropped out of the log or never happened.
+const struct HeapEvent *GetHeapEvent(u32 age)
+{
+    if (age >= HEAP_LOG_LENGTH || age >= sHeapLogCount)
+        return NULL;
+
+    return &sHeapLog[(sHeapLogCount - 1 - age) % HEAP_LOG_LENGTH];
+}
+
+// Returns the leak that was found `age` leaks ago (0 being the most recent),
+// or NULL if it has dropped out of the list or never happened.
+const struct HeapLeak *GetHeapLeak(u32 age)
+{
+    if (age >= HEAP_LEAK_LIST_LENGTH || age >= sHeapLeakCount)
+        return NULL;
+
+    return &sHeapLeaks[(sHeapLeakCount - 1 - age) % HEAP_LEAK_LIST_LENGTH];
+}
+
+u32 GetHeapLeakCount(void)
+{
+    return sHeapLeakCount;
+}
+
+static void RecordHeapLeaks(u32 firstEpoch, u32 lastEpoch)
+{
+    struct MemBlock *pos = (struct MemBlock *)sHeapStart;
+    struct HeapLeak *leak;
+
+    if (pos == NULL)
+        return;
+
+    do {
+        if (pos->flag && pos->epoch >= firstEpoch && pos->epoch <= lastEpoch)
+        {
+            leak = &sHeapLeaks[sHeapLeakCount % HEAP_LEAK_LIST_LENGTH];
+            leak->caller = pos->caller;
+            leak->owner = pos->owner;
+            leak->pointer = pos->data;
+            leak->size = pos->size;
+            sHeapLeakCount++;
+            pos->epoch = HEAP_EPOCH_REPORTED;
+        }
+        pos = pos->next;
+    } while (pos != (struct MemBlock *)sHeapStart);
+}
+
+// Called whenever the main callback changes. A screen is over once the game
+// goes back to a callback it left earlier, e.g. the overworld or the party
+// menu. Blocks made by the callbacks in between are leaks if they are still
+// live by then, except those made after the screen's main loop (the callback
+// that ran the most frames) was left, which belong to the way back.
+void CheckHeapLeaks(void (*nextCallback)(void))
+{
+    struct HeapScreen *screen;
+    u32 i, j, mainLoop;
+
+    if (nextCallback == gMain.callback2)
+        return;
+
+    if (sHeapScreenCount == HEAP_SCREEN_HISTORY_LENGTH)
+    {
+        for (i = 1; i < HEAP_SCREEN_HISTORY_LENGTH; i++)
+            sHeapScreens[i - 1] = sHeapScreens[i];
+        sHeapScreenCount--;
+    }
+
+    screen = &sHeapScreens[sHeapScreenCount++];
+    screen->callback = gMain.callback2;
+    screen->epoch = sHeapEpoch;
+    screen->frames = gMain.vblankCounter1 - sHeapScreenStartFrame;
+
+    sHeapEpoch++;
+    sHeapScreenStartFrame = gMain.vblankCounter1;
+
+    // Look for the next callback below the one just pushed.
+    for (i = sHeapScreenCount - 1; i-- != 0;)
+    {
+        if (sHeapScreens[i].callback != nextCallback)
+            continue;
+
+        mainLoop = i + 1;
+        for (j = i + 2; j < sHeapScreenCount; j++)
+        {
+            if (sHeapScreens[j].frames > sHeapScreens[mainLoop].frames)
+                mainLoop = j;
+        }
+
+        RecordHeapLeaks(sHeapScreens[i + 1].epoch, sHeapScreens[mainLoop].epoch);
+        sHeapScreenCount = i;
+        break;
+    }
+}
+
+#endif // DEBUG
@@ -14,9 +14,63 @@
 
 extern u8 gHeap[];
 
+// A bump allocator over one block of the heap. See ArenaBegin.
+struct Arena {
+    u8 *start;
+    u32 size;
+    u32 used;
+};
+
 void *Alloc(u32 size);
 void *AllocZeroed(u32 size);
 void Free(void *pointer);
 void InitHeap(void *pointer, u32 size);
+bool32 ArenaBegin(struct Arena *arena, u32 size);
+void *ArenaAlloc(struct Arena *arena, u32 size);
+void ArenaReset(struct Arena *arena);
+
+#if DEBUG
+#define HEAP_LOG_LENGTH 32
+#define HEAP_LEAK_LIST_LENGTH 16
+
+enum {
+    HEAP_EVENT_ALLOC,
+    HEAP_EVENT_FREE,
+    HEAP_EVENT_FAIL,
+};
+
+// One Alloc or Free call, as kept in the heap log. For allocations size is
+// the requested size, for frees it's the size of the block given back.
+struct HeapEvent {
+    const void *caller;
+    void *pointer;
+    u32 size:24;
+    u32 type:8;
+};
+
+struct HeapStats {
+    u32 liveBytes;
+    u32 peakLiveBytes;
+    u32 liveBlocks;
+    u32 freeBytes;
+    u32 largestFreeBlock;
+    u32 fragmentation; // Percentage of free bytes outside the largest free block.
+};
+
+// A block found still live after the screen that allocated it was left.
+// owner is the main callback that was running when it was allocated.
+struct HeapLeak {
+    const void *caller;
+    const void *owner;
+    void *pointer;
+    u32 size;
+};
+
+void GetHeapStats(struct HeapStats *stats);
+const struct HeapEvent *GetHeapEvent(u32 age);
+const struct HeapLeak *GetHeapLeak(u32 age);
+u32 GetHeapLeakCount(void);
+void CheckHeapLeaks(void (*nextCallback)(void));
+#endif
 
 #endif // GUARD_ALLOC_H
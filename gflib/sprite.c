@@ -3,6 +3,10 @@
 #include "main.h"
 #include "palette.h"
 #include "day_night.h"
+#include "util.h"
+#if DEBUG
+#include "task.h"
+#endif
 
 #define MAX_SPRITE_COPY_REQUESTS 64
 
@@ -14,17 +18,7 @@
     (sSpriteTileRanges + 1)[index * 2] = count;    \
 }
 
-#define ALLOC_SPRITE_TILE(n)                             \
-{                                                        \
-    sSpriteTileAllocBitmap[(n) / 8] |= (1 << ((n) % 8)); \
-}
-
-#define FREE_SPRITE_TILE(n)                               \
-{                                                         \
-    sSpriteTileAllocBitmap[(n) / 8] &= ~(1 << ((n) % 8)); \
-}
-
-#define SPRITE_TILE_IS_ALLOCATED(n) ((sSpriteTileAllocBitmap[(n) / 8] >> ((n) % 8)) & 1)
+#define SPRITE_TILE_WORD_COUNT (TOTAL_OBJ_TILE_COUNT / 32)
 
 
 struct SpriteCopyRequest
@@ -40,6 +34,28 @@ struct OamDimensions
     s8 height;
 };
 
+// Everything AddSubspritesToOamBuffer reads from a sprite. If none of it
+// changed since the last frame, neither did the OAM entries built from it.
+struct SpriteOamInputs
+{
+    struct OamData oam;
+    const struct SubspriteTable *subspriteTables;
+    s8 centerToCornerVecX;
+    s8 centerToCornerVecY;
+    u8 subspriteTableNum;
+    u8 subspriteMode:2;
+    u8 alwaysDirty:1;
+};
+
+// Where a subsprite sprite's entries were built, and in which build.
+struct SubspriteOamCache
+{
+    struct SpriteOamInputs inputs;
+    u32 buildId;
+    u8 oamIndex;
+    u8 oamCount;
+};
+
 static void UpdateOamCoords(void);
 static void BuildSpritePriorities(void);
 static void SortSprites(void);
@@ -49,6 +65,7 @@ static u8 CreateSpriteAt(u8 index, const struct SpriteTemplate *template, s16 x,
 static void ResetOamMatrices(void);
 static void ResetSprite(struct Sprite *sprite);
 static s16 AllocSpriteTiles(u16 tileCount);
+static void SetSpriteTilesAllocated(u16 start, u16 count, bool32 allocated);
 static void RequestSpriteFrameImageCopy(u16 index, u16 tileNum, const struct SpriteFrameImage *images);
 static void ResetAllSprites(void);
 static void BeginAnim(struct Sprite *sprite);
@@ -299,14 +316,17 @@ u32 gOamMatrixAllocBitmap;
 u8 gReservedSpritePaletteCount;
 
 EWRAM_DATA struct Sprite gSprites[MAX_SPRITES + 1] = {0};
-EWRAM_DATA static u16 sSpritePriorities[MAX_SPRITES] = {0};
+EWRAM_DATA static u32 sSpriteSortKeys[MAX_SPRITES] = {0};
 EWRAM_DATA static u8 sSpriteOrder[MAX_SPRITES] = {0};
+EWRAM_DATA static struct SubspriteOamCache sSubspriteOamCache[MAX_SPRITES] = {0};
+EWRAM_DATA static u32 sOamBuildId = 0;
 EWRAM_DATA static bool8 sShouldProcessSpriteCopyRequests = 0;
 EWRAM_DATA static u8 sSpriteCopyRequestCount = 0;
 EWRAM_DATA static struct SpriteCopyRequest sSpriteCopyRequests[MAX_SPRITES] = {0};
 EWRAM_DATA u8 gOamLimit = 0;
 EWRAM_DATA u16 gReservedSpriteTileCount = 0;
-EWRAM_DATA static u8 sSpriteTileAllocBitmap[128] = {0};
+EWRAM_DATA static u32 sSpriteTileAllocBitmap[SPRITE_TILE_WORD_COUNT] = {0};
+EWRAM_DATA static u32 sFullSpriteTileWords = 0; // Bit n is set if word n of the bitmap is all ones.
 EWRAM_DATA s16 gSpriteCoordOffsetX = 0;
 EWRAM_DATA s16 gSpriteCoordOffsetY = 0;
 EWRAM_DATA struct OamMatrix gOamMatrices[OAM_MATRIX_COUNT] = {0};
@@ -326,9 +346,41 @@ void ResetSpriteData(void)
     gSpriteCoordOffsetY = 0;
 }
 
+#if DEBUG
+static void AnimateSpritesProfiled(void)
+{
+    u8 i;
+    for (i = 0; i < MAX_SPRITES; i++)
+    {
+        struct Sprite *sprite = &gSprites[i];
+
+        if (sprite->inUse)
+        {
+            SpriteCallback callback = sprite->callback;
+            u16 start = ProfilerBegin();
+
+            callback(sprite);
+            ProfilerEnd((const void *)callback, start, TRUE);
+
+            if (sprite->inUse)
+                AnimateSprite(sprite);
+        }
+    }
+}
+#endif
+
 void AnimateSprites(void)
 {
     u8 i;
+
+#if DEBUG
+    if (gProfilerEnabled)
+    {
+        AnimateSpritesProfiled();
+        return;
+    }
+#endif
+
     for (i = 0; i < MAX_SPRITES; i++)
     {
         struct Sprite *sprite = &gSprites[i];
@@ -379,107 +431,53 @@ void UpdateOamCoords(void)
     }
 }
 
+// Sprites are drawn in order of priority, then subpriority, and among equals
+// the one lower on screen is drawn in front. All three are folded into one key
+// so that SortSprites only has to compare integers.
+static u32 GetSpriteSortKey(struct Sprite *sprite)
+{
+    s32 y = sprite->oam.y;
+
+    // Sprites near the bottom of the 256-pixel wrap are really above the screen.
+    if (y >= DISPLAY_HEIGHT)
+        y -= 256;
+
+    // So are the big double-size affine sprites that hang off the top.
+    if (sprite->oam.affineMode == ST_OAM_AFFINE_DOUBLE
+     && sprite->oam.size == ST_OAM_SIZE_3
+     && (sprite->oam.shape == ST_OAM_SQUARE || sprite->oam.shape == ST_OAM_V_RECTANGLE)
+     && y > 128)
+        y -= 256;
+
+    // y is now in [-127, DISPLAY_HEIGHT), which takes 9 bits once flipped.
+    return (((sprite->oam.priority << 8) | sprite->subpriority) << 9) | (DISPLAY_HEIGHT - 1 - y);
+}
+
 void BuildSpritePriorities(void)
 {
     u16 i;
     for (i = 0; i < MAX_SPRITES; i++)
-    {
-        struct Sprite *sprite = &gSprites[i];
-        u16 priority = sprite->subpriority | (sprite->oam.priority << 8);
-        sSpritePriorities[i] = priority;
-    }
+        sSpriteSortKeys[i] = GetSpriteSortKey(&gSprites[i]);
 }
 
+// Stable insertion sort of last frame's order. Sprites rarely change places
+// between frames, so this is usually a single pass with no moves.
 void SortSprites(void)
 {
     u8 i;
     for (i = 1; i < MAX_SPRITES; i++)
     {
+        u8 index = sSpriteOrder[i];
+        u32 key = sSpriteSortKeys[index];
         u8 j = i;
-        struct Sprite *sprite1 = &gSprites[sSpriteOrder[i - 1]];
-        struct Sprite *sprite2 = &gSprites[sSpriteOrder[i]];
-        u16 sprite1Priority = sSpritePriorities[sSpriteOrder[i - 1]];
-        u16 sprite2Priority = sSpritePriorities[sSpriteOrder[i]];
-        s16 sprite1Y = sprite1->oam.y;
-        s16 sprite2Y = sprite2->oam.y;
-
-        if (sprite1Y >= DISPLAY_HEIGHT)
-            sprite1Y = sprite1Y - 256;
-
-        if (sprite2Y >= DISPLAY_HEIGHT)
-            sprite2Y = sprite2Y - 256;
 
-        if (sprite1->oam.affineMode == ST_OAM_AFFINE_DOUBLE
-         && sprite1->oam.size == ST_OAM_SIZE_3)
+        while (j > 0 && sSpriteSortKeys[sSpriteOrder[j - 1]] > key)
         {
-            u32 shape = sprite1->oam.shape;
-            if (shape == ST_OAM_SQUARE || shape == ST_OAM_V_RECTANGLE)
-            {
-                if (sprite1Y > 128)
-                    sprite1Y = sprite1Y - 256;
-            }
-        }
-
-        if (sprite2->oam.affineMode == ST_OAM_AFFINE_DOUBLE
-         && sprite2->oam.size == ST_OAM_SIZE_3)
-        {
-            u32 shape = sprite2->oam.shape;
-            if (shape == ST_OAM_SQUARE || shape == ST_OAM_V_RECTANGLE)
-            {
-                if (sprite2Y > 128)
-                    sprite2Y = sprite2Y - 256;
-            }
-        }
-
-        while (j > 0
-            && ((sprite1Priority > sprite2Priority)
-             || (sprite1Priority == sprite2Priority && sprite1Y < sprite2Y)))
-        {
-            u8 temp = sSpriteOrder[j];
             sSpriteOrder[j] = sSpriteOrder[j - 1];
-            sSpriteOrder[j - 1] = temp;
-
-            // UB: If j equals 1, then j-- makes j equal 0.
-            // Then, sSpriteOrder[-1] gets accessed below.
-            // Although this doesn't result in a bug in the ROM,
-            // the behavior is undefined.
             j--;
-
-            sprite1 = &gSprites[sSpriteOrder[j - 1]];
-            sprite2 = &gSprites[sSpriteOrder[j]];
-            sprite1Priority = sSpritePriorities[sSpriteOrder[j - 1]];
-            sprite2Priority = sSpritePriorities[sSpriteOrder[j]];
-            sprite1Y = sprite1->oam.y;
-            sprite2Y = sprite2->oam.y;
-
-            if (sprite1Y >= DISPLAY_HEIGHT)
-                sprite1Y = sprite1Y - 256;
-
-            if (sprite2Y >= DISPLAY_HEIGHT)
-                sprite2Y = sprite2Y - 256;
-
-            if (sprite1->oam.affineMode == ST_OAM_AFFINE_DOUBLE
-             && sprite1->oam.size == ST_OAM_SIZE_3)
-            {
-                u32 shape = sprite1->oam.shape;
-                if (shape == ST_OAM_SQUARE || shape == ST_OAM_V_RECTANGLE)
-                {
-                    if (sprite1Y > 128)
-                        sprite1Y = sprite1Y - 256;
-                }
-            }
-
-            if (sprite2->oam.affineMode == ST_OAM_AFFINE_DOUBLE
-             && sprite2->oam.size == ST_OAM_SIZE_3)
-            {
-                u32 shape = sprite2->oam.shape;
-                if (shape == ST_OAM_SQUARE || shape == ST_OAM_V_RECTANGLE)
-                {
-                    if (sprite2Y > 128)
-                        sprite2Y = sprite2Y - 256;
-                }
-            }
         }
+
+        sSpriteOrder[j] = index;
     }
 }
 
@@ -496,16 +494,104 @@ void CopyMatricesToOamBuffer(void)
     }
 }
 
+static void GetSpriteOamInputs(struct Sprite *sprite, struct SpriteOamInputs *inputs)
+{
+    const struct SubspriteTable *subspriteTable = &sprite->subspriteTables[sprite->subspriteTableNum];
+    u32 *words = (u32 *)inputs;
+    u32 i;
+
+    for (i = 0; i < sizeof(*inputs) / 4; i++)
+        words[i] = 0;
+
+    inputs->oam = sprite->oam;
+    inputs->subspriteTables = sprite->subspriteTables;
+    inputs->centerToCornerVecX = sprite->centerToCornerVecX;
+    inputs->centerToCornerVecY = sprite->centerToCornerVecY;
+    inputs->subspriteTableNum = sprite->subspriteTableNum;
+    inputs->subspriteMode = sprite->subspriteMode;
+
+    // Subsprite tables built in RAM (like the list menu's red outline
+    // cursor) can change without the sprite changing, so they're never
+    // trusted.
+    if ((u32)subspriteTable < IWRAM_END || (u32)subspriteTable->subsprites < IWRAM_END)
+        inputs->alwaysDirty = TRUE;
+}
+
+static bool32 SpriteOamInputsEqual(const struct SpriteOamInputs *a, const struct SpriteOamInputs *b)
+{
+    const u32 *wordsA = (const u32 *)a;
+    const u32 *wordsB = (const u32 *)b;
+    u32 i;
+
+    for (i = 0; i < sizeof(*a) / 4; i++)
+    {
+        if (wordsA[i] != wordsB[i])
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+// Ordinary sprites are a single entry copy, but a sprite with subsprites is
+// expanded entry by entry. If its inputs are unchanged and it starts at the
+// same entry as in the last build, that expansion is still in the buffer:
+// the sprites drawn before it only wrote entries below it.
+static bool8 AddCachedSubspritesToOamBuffer(u8 index, u8 *oamIndex)
+{
+    struct Sprite *sprite = &gSprites[index];
+    struct SubspriteOamCache *cache = &sSubspriteOamCache[index];
+    struct SpriteOamInputs inputs;
+    u8 start = *oamIndex;
+
+    if (start >= gOamLimit)
+        return 1;
+
+    GetSpriteOamInputs(sprite, &inputs);
+
+    if (!inputs.alwaysDirty
+     && cache->buildId == sOamBuildId - 1
+     && cache->oamIndex == start
+     && start + cache->oamCount <= gOamLimit
+     && SpriteOamInputsEqual(&inputs, &cache->inputs))
+    {
+        *oamIndex += cache->oamCount;
+        cache->buildId = sOamBuildId;
+        return 0;
+    }
+
+    if (AddSubspritesToOamBuffer(sprite, &gMain.oamBuffer[start], oamIndex))
+        return 1;
+
+    cache->inputs = inputs;
+    cache->buildId = sOamBuildId;
+    cache->oamIndex = start;
+    cache->oamCount = *oamIndex - start;
+    return 0;
+}
+
 void AddSpritesToOamBuffer(void)
 {
     u8 i = 0;
     u8 oamIndex = 0;
 
+    sOamBuildId++;
+
     while (i < MAX_SPRITES)
     {
-        struct Sprite *sprite = &gSprites[sSpriteOrder[i]];
-        if (sprite->inUse && !sprite->invisible && AddSpriteToOamBuffer(sprite, &oamIndex))
-            return;
+        u8 index = sSpriteOrder[i];
+        struct Sprite *sprite = &gSprites[index];
+        if (sprite->inUse && !sprite->invisible)
+        {
+            if (!sprite->subspriteTables || sprite->subspriteMode == SUBSPRITES_OFF)
+            {
+                if (AddSpriteToOamBuffer(sprite, &oamIndex))
+                    return;
+            }
+            else if (AddCachedSubspritesToOamBuffer(index, &oamIndex))
+            {
+                return;
+            }
+        }
         i++;
     }
 
@@ -640,10 +726,7 @@ void DestroySprite(struct Sprite *sprite)
     {
         if (!sprite->usingSheet)
         {
-            u16 i;
-            u16 tileEnd = (sprite->images->size / TILE_SIZE_4BPP) + sprite->oam.tileNum;
-            for (i = sprite->oam.tileNum; i < tileEnd; i++)
-                FREE_SPRITE_TILE(i);
+            SetSpriteTilesAllocated(sprite->oam.tileNum, sprite->images->size / TILE_SIZE_4BPP, FALSE);
         }
         ResetSprite(sprite);
     }
@@ -658,6 +741,9 @@ void ResetOamRange(u8 a, u8 b)
         struct OamData *oamBuffer = gMain.oamBuffer;
         oamBuffer[i] = *(struct OamData *)&gDummyOamData;
     }
+
+    // Entries built by the last build are gone.
+    sOamBuildId++;
 }
 
 void LoadOam(void)
@@ -722,85 +808,151 @@ void CalcCenterToCornerVec(struct Sprite *sprite, u8 shape, u8 size, u8 affineMo
     sprite->centerToCornerVecY = y;
 }
 
-s16 AllocSpriteTiles(u16 tileCount)
+// Marks tiles [start, start + count) as allocated or free, a bitmap word at a
+// time, and keeps sFullSpriteTileWords in step.
+static void SetSpriteTilesAllocated(u16 start, u16 count, bool32 allocated)
 {
-    u16 i;
-    s16 start;
-    u16 numTilesFound;
+    u32 tile = start;
+    u32 end = start + count;
 
-    if (tileCount == 0)
+    if (end > TOTAL_OBJ_TILE_COUNT)
+        end = TOTAL_OBJ_TILE_COUNT;
+
+    while (tile < end)
     {
-        // Free all unreserved tiles if the tile count is 0.
-        for (i = gReservedSpriteTileCount; i < TOTAL_OBJ_TILE_COUNT; i++)
-            FREE_SPRITE_TILE(i);
+        u32 word = tile / 32;
+        u32 shift = tile % 32;
+        u32 numBits = 32 - shift;
+        u32 mask;
 
-        return 0;
+        if (numBits > end - tile)
+            numBits = end - tile;
+
+        mask = (numBits == 32) ? 0xFFFFFFFF : ((1u << numBits) - 1) << shift;
+
+        if (allocated)
+            sSpriteTileAllocBitmap[word] |= mask;
+        else
+            sSpriteTileAllocBitmap[word] &= ~mask;
+
+        if (sSpriteTileAllocBitmap[word] == 0xFFFFFFFF)
+            sFullSpriteTileWords |= 1u << word;
+        else
+            sFullSpriteTileWords &= ~(1u << word);
+
+        tile += numBits;
     }
+}
 
-    i = gReservedSpriteTileCount;
+// Returns the first tile at or after the given one that is allocated (or free,
+// if allocated is FALSE), or TOTAL_OBJ_TILE_COUNT if there is none. Free tiles
+// are looked for through sFullSpriteTileWords, so runs of fully allocated
+// words are skipped in one step.
+static u32 FindSpriteTile(u32 tile, bool32 allocated)
+{
+    u32 word, bits;
 
-    for (;;)
+    if (tile >= TOTAL_OBJ_TILE_COUNT)
+        return TOTAL_OBJ_TILE_COUNT;
+
+    word = tile / 32;
+    bits = allocated ? sSpriteTileAllocBitmap[word] : ~sSpriteTileAllocBitmap[word];
+    bits &= 0xFFFFFFFF << (tile % 32);
+
+    while (bits == 0)
     {
-        while (SPRITE_TILE_IS_ALLOCATED(i))
+        if (allocated)
         {
-            i++;
+            if (++word == SPRITE_TILE_WORD_COUNT)
+                return TOTAL_OBJ_TILE_COUNT;
+            bits = sSpriteTileAllocBitmap[word];
+        }
+        else
+        {
+            u32 candidates = ~sFullSpriteTileWords & (0xFFFFFFFE << word);
 
-            if (i == TOTAL_OBJ_TILE_COUNT)
-                return -1;
+            if (candidates == 0)
+                return TOTAL_OBJ_TILE_COUNT;
+            word = CountTrailingZeroBits(candidates);
+            bits = ~sSpriteTileAllocBitmap[word];
         }
+    }
 
-        start = i;
-        numTilesFound = 1;
+    return word * 32 + CountTrailingZeroBits(bits);
+}
 
-        while (numTilesFound != tileCount)
-        {
-            i++;
+s16 AllocSpriteTiles(u16 tileCount)
+{
+    u32 start, end;
 
-            if (i == TOTAL_OBJ_TILE_COUNT)
-                return -1;
+    if (tileCount == 0)
+    {
+        // Free all unreserved tiles if the tile count is 0.
+        SetSpriteTilesAllocated(gReservedSpriteTileCount, TOTAL_OBJ_TILE_COUNT - gReservedSpriteTileCount, FALSE);
+        return 0;
+    }
 
-            if (!SPRITE_TILE_IS_ALLOCATED(i))
-                numTilesFound++;
-            else
-                break;
-        }
+    // First fit: hop from each free run to the next until one is long enough.
+    start = gReservedSpriteTileCount;
 
-        if (numTilesFound == tileCount)
+    for (;;)
+    {
+        start = FindSpriteTile(start, FALSE);
+        if (start + tileCount > TOTAL_OBJ_TILE_COUNT)
+            return -1;
+
+        end = FindSpriteTile(start, TRUE);
+        if (end - start >= tileCount)
             break;
+
+        start = end;
     }
 
-    for (i = start; i < tileCount + start; i++)
-        ALLOC_SPRITE_TILE(i);
+    SetSpriteTilesAllocated(start, tileCount, TRUE);
 
     return start;
 }
 
 u8 SpriteTileAllocBitmapOp(u16 bit, u8 op)
 {
-    u8 index = bit / 8;
-    u8 shift = bit % 8;
-    u8 val = bit % 8;
     u8 retVal = 0;
 
     if (op == 0)
-    {
-        val = ~(1 << val);
-        sSpriteTileAllocBitmap[index] &= val;
-    }
+        SetSpriteTilesAllocated(bit, 1, FALSE);
     else if (op == 1)
-    {
-        val = (1 << val);
-        sSpriteTileAllocBitmap[index] |= val;
-    }
+        SetSpriteTilesAllocated(bit, 1, TRUE);
     else
-    {
-        retVal = 1 << shift;
-        retVal &= sSpriteTileAllocBitmap[index];
-    }
+        retVal = (sSpriteTileAllocBitmap[bit / 32] >> (bit % 32)) & 1;
 
     return retVal;
 }
 
+// Summarizes OBJ VRAM usage, for debugging sprites that fail to load.
+void GetSpriteTileStats(struct SpriteTileStats *stats)
+{
+    u32 start = gReservedSpriteTileCount;
+    u32 end;
+
+    stats->freeTiles = 0;
+    stats->freeRuns = 0;
+    stats->largestFreeRun = 0;
+
+    for (;;)
+    {
+        start = FindSpriteTile(start, FALSE);
+        if (start == TOTAL_OBJ_TILE_COUNT)
+            break;
+
+        end = FindSpriteTile(start, TRUE);
+        stats->freeTiles += end - start;
+        stats->freeRuns++;
+        if (end - start > stats->largestFreeRun)
+            stats->largestFreeRun = end - start;
+
+        start = end;
+    }
+}
+
 void SpriteCallbackDummy(struct Sprite *sprite)
 {
 }
@@ -879,6 +1031,7 @@ void ResetAllSprites(void)
     }
 
     ResetSprite(&gSprites[i]);
+    sOamBuildId++;
 }
 
 // UB: template pointer may point to freed temporary storage
@@ -1523,7 +1676,6 @@ void FreeSpriteTilesByTag(u16 tag)
     u8 index = IndexOfSpriteTileTag(tag);
     if (index != 0xFF)
     {
-        u16 i;
         u16 *rangeStarts;
         u16 *rangeCounts;
         u16 start;
@@ -1533,8 +1685,7 @@ void FreeSpriteTilesByTag(u16 tag)
         rangeCounts = sSpriteTileRanges + 1;
         count = rangeCounts[index * 2];
 
-        for (i = start; i < start + count; i++)
-            FREE_SPRITE_TILE(i);
+        SetSpriteTilesAllocated(start, count, FALSE);
 
         sSpriteTileRangeTags[index] = 0xFFFF;
     }
@@ -248,6 +248,13 @@ struct OamMatrix
     s16 d;
 };
 
+struct SpriteTileStats
+{
+    u16 freeTiles;
+    u16 freeRuns;
+    u16 largestFreeRun;
+};
+
 extern const struct OamData gDummyOamData;
 extern const union AnimCmd *const gDummySpriteAnimTable[];
 extern const union AffineAnimCmd *const gDummySpriteAffineAnimTable[];
@@ -322,6 +329,7 @@ bool8 AddSubspritesToOamBuffer(struct Sprite *sprite, struct OamData *destOam, u
 void CopyToSprites(u8 *src);
 void CopyFromSprites(u8 *dest);
 u8 SpriteTileAllocBitmapOp(u16 bit, u8 op);
+void GetSpriteTileStats(struct SpriteTileStats *stats);
 void ClearSpriteCopyRequests(void);
 void ResetAffineAnimData(void);
 
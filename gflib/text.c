@@ -20,6 +20,22 @@ static u16 gLastTextBgColor;
 static u16 gLastTextFgColor;
 static u16 gLastTextShadowColor;
 
+// Colorized glyphs are kept in a small set-associative cache, so redrawing
+// the same menu text skips decompressing and color-expanding each tile again.
+#define GLYPH_CACHE_SETS 8
+#define GLYPH_CACHE_WAYS 4
+
+struct GlyphCacheEntry
+{
+    u32 key; // 0 if unused
+    u16 lastUsed;
+    struct Struct_03002F90 glyph;
+};
+
+EWRAM_DATA static struct GlyphCacheEntry sGlyphCache[GLYPH_CACHE_SETS][GLYPH_CACHE_WAYS] = {0};
+EWRAM_DATA static struct GlyphCacheStats sGlyphCacheStats = {0};
+EWRAM_DATA static u16 sGlyphCacheTick = 0;
+
 const struct FontInfo *gFonts;
 bool8 gUnknown_03002F84;
 struct Struct_03002F90 gUnknown_03002F90;
@@ -216,6 +232,35 @@ extern const u16 gFont1JapaneseGlyphs[];
 extern const u16 gFont2JapaneseGlyphs[];
 extern const u8 gFont2JapaneseGlyphWidths[];
 
+// The data behind gGlyphWidthFuncs, so GetStringWidth can look widths up
+// directly instead of calling through a function pointer per glyph.
+static const struct GlyphWidthTable sGlyphWidthTables[] =
+{
+    [0] = { gFont0LatinGlyphWidths, NULL, 0, 8 },
+    [1] = { gFont1LatinGlyphWidths, NULL, 0, 8 },
+    [2] = { gFont2LatinGlyphWidths, gFont2JapaneseGlyphWidths, 0, 0 },
+    [3] = { gFont2LatinGlyphWidths, gFont2JapaneseGlyphWidths, 0, 0 },
+    [4] = { gFont2LatinGlyphWidths, gFont2JapaneseGlyphWidths, 0, 0 },
+    [5] = { gFont2LatinGlyphWidths, gFont2JapaneseGlyphWidths, 0, 0 },
+    [6] = { NULL, NULL, 0x10, 0x10 },
+    [7] = { gFont7LatinGlyphWidths, NULL, 0, 8 },
+    [8] = { gFont8LatinGlyphWidths, NULL, 0, 8 },
+};
+
+// Widths of strings in ROM, keyed by address. Menus measure the same strings
+// every time they redraw to align or center them.
+#define STRING_WIDTH_CACHE_SIZE 32
+
+struct StringWidthCacheEntry
+{
+    const u8 *str;
+    s16 letterSpacing;
+    u8 fontId;
+    s32 width;
+};
+
+EWRAM_DATA static struct StringWidthCacheEntry sStringWidthCache[STRING_WIDTH_CACHE_SIZE] = {0};
+
 void SetFontsPointer(const struct FontInfo *fonts)
 {
     gFonts = fonts;
@@ -393,6 +438,11 @@ void GenerateFontHalfRowLookupTable(u8 fgColor, u8 bgColor, u8 shadowColor)
 
     u16 *current = gFontHalfRowLookupTable;
 
+    // Text often resets the colors it's already using. The table starts out
+    // zeroed, which is also what it holds for all-zero colors.
+    if (bgColor == gLastTextBgColor && fgColor == gLastTextFgColor && shadowColor == gLastTextShadowColor)
+        return;
+
     gLastTextBgColor = bgColor;
     gLastTextFgColor = fgColor;
     gLastTextShadowColor = shadowColor;
@@ -580,6 +630,105 @@ void DecompressGlyphTile(const void *src_, void *dest_)
     *(dest++) = ((gFontHalfRowLookupTable[gFontHalfRowOffsets[temp & 0xFF]]) << 16) | (gFontHalfRowLookupTable[gFontHalfRowOffsets[temp >> 8]]);
 }
 
+static void DecompressGlyph(u8 fontType, u16 glyphId, bool32 isJapanese)
+{
+    switch (fontType)
+    {
+    case 0:
+        DecompressGlyphFont0(glyphId, isJapanese);
+        break;
+    case 1:
+        DecompressGlyphFont1(glyphId, isJapanese);
+        break;
+    case 2:
+    case 3:
+    case 4:
+    case 5:
+        DecompressGlyphFont2(glyphId, isJapanese);
+        break;
+    case 7:
+        DecompressGlyphFont7(glyphId, isJapanese);
+        break;
+    case 8:
+        DecompressGlyphFont8(glyphId, isJapanese);
+        break;
+    }
+}
+
+// Only the quarters CopyGlyphToWindow will read are copied. Every font is
+// taller than 8 pixels, and the right half only matters for wide glyphs.
+static void CopyGlyph(struct Struct_03002F90 *dest, const struct Struct_03002F90 *src)
+{
+    memcpy(dest->unk0, src->unk0, sizeof(dest->unk0));
+    memcpy(dest->unk40, src->unk40, sizeof(dest->unk40));
+    if (src->width > 8)
+    {
+        memcpy(dest->unk20, src->unk20, sizeof(dest->unk20));
+        memcpy(dest->unk60, src->unk60, sizeof(dest->unk60));
+    }
+    dest->width = src->width;
+    dest->height = src->height;
+}
+
+// Decompresses a glyph into gUnknown_03002F90 using the current text colors,
+// reusing a previous result for the same font, glyph and colors if cached.
+static void DecompressGlyphCached(u8 fontType, u16 glyphId, bool32 isJapanese)
+{
+    struct GlyphCacheEntry *set;
+    struct GlyphCacheEntry *victim;
+    u32 key;
+    s32 i;
+
+    // Fonts 3-5 share font 2's glyphs.
+    if (fontType >= 3 && fontType <= 5)
+        fontType = 2;
+
+    // Out-of-range colors bleed across nibbles, so they don't fit in the key.
+    if (glyphId >= 0x8000 || (gLastTextFgColor | gLastTextBgColor | gLastTextShadowColor) > 0xF)
+    {
+        DecompressGlyph(fontType, glyphId, isJapanese);
+        return;
+    }
+
+    key = (fontType + 1)
+        | ((isJapanese == TRUE) << 4)
+        | (gLastTextFgColor << 5)
+        | (gLastTextBgColor << 9)
+        | (gLastTextShadowColor << 13)
+        | (glyphId << 17);
+
+    set = sGlyphCache[(glyphId ^ (glyphId >> 3) ^ fontType) % GLYPH_CACHE_SETS];
+    sGlyphCacheTick++;
+
+    victim = &set[0];
+    for (i = 0; i < GLYPH_CACHE_WAYS; i++)
+    {
+        if (set[i].key == key)
+        {
+            set[i].lastUsed = sGlyphCacheTick;
+            CopyGlyph(&gUnknown_03002F90, &set[i].glyph);
+            sGlyphCacheStats.hits++;
+            return;
+        }
+
+        // Prefer an unused entry, then the least recently used one.
+        if (victim->key != 0
+         && (set[i].key == 0 || (u16)(sGlyphCacheTick - set[i].lastUsed) > (u16)(sGlyphCacheTick - victim->lastUsed)))
+            victim = &set[i];
+    }
+
+    DecompressGlyph(fontType, glyphId, isJapanese);
+    victim->key = key;
+    victim->lastUsed = sGlyphCacheTick;
+    CopyGlyph(&victim->glyph, &gUnknown_03002F90);
+    sGlyphCacheStats.misses++;
+}
+
+void GetGlyphCacheStats(struct GlyphCacheStats *stats)
+{
+    *stats = sGlyphCacheStats;
+}
+
 u8 GetLastTextColor(u8 colorType)
 {
     switch (colorType)
@@ -624,6 +773,34 @@ u8 GetLastTextColor(u8 colorType)
         }                                                                                                         \
     }
 
+// Draws up to 8x8 pixels of a glyph a tile row at a time. Each word of rows is
+// one glyph row, in the same nibble order as a tile row, so it only needs to be
+// shifted to x's position within the tile and merged where it's opaque.
+static void CopyGlyphRowsToWindow(u8 *windowTiles, u32 widthOffset, u32 x, u32 y, u32 width, u32 height, const u32 *rows)
+{
+    u32 shift = (x % 8) * 4;
+    u32 widthMask = (width >= 8) ? 0xFFFFFFFF : (1 << (width * 4)) - 1;
+    u32 i, pixels, opaque;
+    u32 *tileRow;
+
+    for (i = 0; i < height; i++, y++)
+    {
+        pixels = rows[i] & widthMask;
+        if (pixels == 0)
+            continue;
+
+        opaque = pixels | (pixels >> 1) | (pixels >> 2) | (pixels >> 3);
+        opaque = (opaque & 0x11111111) * 0xF;
+
+        tileRow = (u32 *)(windowTiles + (x / 8) * 32 + (y / 8) * widthOffset + (y % 8) * 4);
+        tileRow[0] = (tileRow[0] & ~(opaque << shift)) | (pixels << shift);
+
+        // Whatever didn't fit goes to the same row of the next tile.
+        if (shift != 0 && (opaque >> (32 - shift)) != 0)
+            tileRow[8] = (tileRow[8] & ~(opaque >> (32 - shift))) | (pixels >> (32 - shift));
+    }
+}
+
 void CopyGlyphToWindow(struct TextPrinter *textPrinter)
 {
     struct Window *win;
@@ -650,7 +827,20 @@ void CopyGlyphToWindow(struct TextPrinter *textPrinter)
     windowTiles = win->tileData;
     widthOffset = winTempl->width * 32;
 
-    if (r4 < 9)
+    if (r4 <= 0 || r0 <= 0)
+        return;
+
+    if (((u32)windowTiles & 3) == 0)
+    {
+        CopyGlyphRowsToWindow(windowTiles, widthOffset, currX, currY, min(r4, 8), min(r0, 8), unkStruct->unk0);
+        if (r4 > 8)
+            CopyGlyphRowsToWindow(windowTiles, widthOffset, currX + 8, currY, r4 - 8, min(r0, 8), unkStruct->unk20);
+        if (r0 > 8)
+            CopyGlyphRowsToWindow(windowTiles, widthOffset, currX, currY + 8, min(r4, 8), r0 - 8, unkStruct->unk40);
+        if (r4 > 8 && r0 > 8)
+            CopyGlyphRowsToWindow(windowTiles, widthOffset, currX + 8, currY + 8, r4 - 8, r0 - 8, unkStruct->unk60);
+    }
+    else if (r4 < 9)
     {
         if (r0 < 9)
         {
@@ -692,6 +882,8 @@ void CopyGlyphToWindow(struct TextPrinter *textPrinter)
             }
         }
     }
+
+    MarkWindowPixelRectDirty(textPrinter->printerTemplate.windowId, currX, currY, r4, r0);
 }
 void ClearTextSpan(struct TextPrinter *textPrinter, u32 width)
 {
@@ -717,6 +909,12 @@ void ClearTextSpan(struct TextPrinter *textPrinter, u32 width)
             width,
             *glyphHeight,
             gLastTextBgColor);
+        MarkWindowPixelRectDirty(
+            textPrinter->printerTemplate.windowId,
+            textPrinter->printerTemplate.currentX,
+            textPrinter->printerTemplate.currentY,
+            width,
+            *glyphHeight);
     }
 }
 
@@ -985,236 +1183,245 @@ void DrawDownArrow(u8 windowId, u16 x, u16 y, u8 bgColor, bool8 drawArrow, u8 *c
     }
 }
 
-u16 RenderText(struct TextPrinter *textPrinter)
+static u16 RenderTextCharacter(struct TextPrinter *textPrinter)
 {
     struct TextPrinterSubStruct *subStruct = (struct TextPrinterSubStruct *)(&textPrinter->subStructFields);
     u16 currChar;
     s32 width;
     s32 widthHelper;
 
-    switch (textPrinter->state)
-    {
-    case 0:
-        if ((JOY_HELD(A_BUTTON | B_BUTTON)) && subStruct->hasPrintBeenSpedUp)
-            textPrinter->delayCounter = 0;
-
-        if (textPrinter->delayCounter && textPrinter->textSpeed)
-        {
-            textPrinter->delayCounter--;
-            if (gTextFlags.canABSpeedUpPrint && (JOY_NEW(A_BUTTON | B_BUTTON)))
-            {
-                subStruct->hasPrintBeenSpedUp = TRUE;
-                textPrinter->delayCounter = 0;
-            }
-            return 3;
-        }
-
-        if (!(gBattleTypeFlags & BATTLE_TYPE_RECORDED) && gTextFlags.autoScroll)
-            textPrinter->delayCounter = 3;
-        else
-            textPrinter->delayCounter = textPrinter->textSpeed;
+    currChar = *textPrinter->printerTemplate.currentChar;
+    textPrinter->printerTemplate.currentChar++;
 
+    switch (currChar)
+    {
+    case CHAR_NEWLINE:
+        textPrinter->printerTemplate.currentX = textPrinter->printerTemplate.x;
+        textPrinter->printerTemplate.currentY += (gFonts[textPrinter->printerTemplate.fontId].maxLetterHeight + textPrinter->printerTemplate.lineSpacing);
+        return 2;
+    case PLACEHOLDER_BEGIN:
+        textPrinter->printerTemplate.currentChar++;
+        return 2;
+    case EXT_CTRL_CODE_BEGIN:
         currChar = *textPrinter->printerTemplate.currentChar;
         textPrinter->printerTemplate.currentChar++;
-
         switch (currChar)
         {
-        case CHAR_NEWLINE:
-            textPrinter->printerTemplate.currentX = textPrinter->printerTemplate.x;
-            textPrinter->printerTemplate.currentY += (gFonts[textPrinter->printerTemplate.fontId].maxLetterHeight + textPrinter->printerTemplate.lineSpacing);
+        case EXT_CTRL_CODE_COLOR:
+            textPrinter->printerTemplate.fgColor = *textPrinter->printerTemplate.currentChar;
+            textPrinter->printerTemplate.currentChar++;
+            GenerateFontHalfRowLookupTable(textPrinter->printerTemplate.fgColor, textPrinter->printerTemplate.bgColor, textPrinter->printerTemplate.shadowColor);
             return 2;
-        case PLACEHOLDER_BEGIN:
+        case EXT_CTRL_CODE_HIGHLIGHT:
+            textPrinter->printerTemplate.bgColor = *textPrinter->printerTemplate.currentChar;
             textPrinter->printerTemplate.currentChar++;
+            GenerateFontHalfRowLookupTable(textPrinter->printerTemplate.fgColor, textPrinter->printerTemplate.bgColor, textPrinter->printerTemplate.shadowColor);
             return 2;
-        case EXT_CTRL_CODE_BEGIN:
+        case EXT_CTRL_CODE_SHADOW:
+            textPrinter->printerTemplate.shadowColor = *textPrinter->printerTemplate.currentChar;
+            textPrinter->printerTemplate.currentChar++;
+            GenerateFontHalfRowLookupTable(textPrinter->printerTemplate.fgColor, textPrinter->printerTemplate.bgColor, textPrinter->printerTemplate.shadowColor);
+            return 2;
+        case EXT_CTRL_CODE_COLOR_HIGHLIGHT_SHADOW:
+            textPrinter->printerTemplate.fgColor = *textPrinter->printerTemplate.currentChar;
+            textPrinter->printerTemplate.currentChar++;
+            textPrinter->printerTemplate.bgColor = *textPrinter->printerTemplate.currentChar;
+            textPrinter->printerTemplate.currentChar++;
+            textPrinter->printerTemplate.shadowColor = *textPrinter->printerTemplate.currentChar;
+            textPrinter->printerTemplate.currentChar++;
+            GenerateFontHalfRowLookupTable(textPrinter->printerTemplate.fgColor, textPrinter->printerTemplate.bgColor, textPrinter->printerTemplate.shadowColor);
+            return 2;
+        case EXT_CTRL_CODE_PALETTE:
+            textPrinter->printerTemplate.currentChar++;
+            return 2;
+        case EXT_CTRL_CODE_FONT:
+            subStruct->glyphId = *textPrinter->printerTemplate.currentChar;
+            textPrinter->printerTemplate.currentChar++;
+            return 2;
+        case EXT_CTRL_CODE_RESET_SIZE:
+            return 2;
+        case EXT_CTRL_CODE_PAUSE:
+            textPrinter->delayCounter = *textPrinter->printerTemplate.currentChar;
+            textPrinter->printerTemplate.currentChar++;
+            textPrinter->state = 6;
+            return 2;
+        case EXT_CTRL_CODE_PAUSE_UNTIL_PRESS:
+            textPrinter->state = 1;
+            if (gTextFlags.autoScroll)
+                subStruct->autoScrollDelay = 0;
+            return 3;
+        case EXT_CTRL_CODE_WAIT_SE:
+            textPrinter->state = 5;
+            return 3;
+        case EXT_CTRL_CODE_PLAY_BGM:
+            currChar = *textPrinter->printerTemplate.currentChar;
+            textPrinter->printerTemplate.currentChar++;
+            currChar |= *textPrinter->printerTemplate.currentChar << 8;
+            textPrinter->printerTemplate.currentChar++;
+            PlayBGM(currChar);
+            return 2;
+        case EXT_CTRL_CODE_ESCAPE:
+            currChar = *textPrinter->printerTemplate.currentChar | 0x100;
+            textPrinter->printerTemplate.currentChar++;
+            break;
+        case EXT_CTRL_CODE_PLAY_SE:
             currChar = *textPrinter->printerTemplate.currentChar;
             textPrinter->printerTemplate.currentChar++;
-            switch (currChar)
+            currChar |= (*textPrinter->printerTemplate.currentChar << 8);
+            textPrinter->printerTemplate.currentChar++;
+            PlaySE(currChar);
+            return 2;
+        case EXT_CTRL_CODE_SHIFT_TEXT:
+            textPrinter->printerTemplate.currentX = textPrinter->printerTemplate.x + *textPrinter->printerTemplate.currentChar;
+            textPrinter->printerTemplate.currentChar++;
+            return 2;
+        case EXT_CTRL_CODE_SHIFT_DOWN:
+            textPrinter->printerTemplate.currentY = textPrinter->printerTemplate.y + *textPrinter->printerTemplate.currentChar;
+            textPrinter->printerTemplate.currentChar++;
+            return 2;
+        case EXT_CTRL_CODE_FILL_WINDOW:
+            FillWindowPixelBuffer(textPrinter->printerTemplate.windowId, PIXEL_FILL(textPrinter->printerTemplate.bgColor));
+            textPrinter->printerTemplate.currentX = textPrinter->printerTemplate.x;
+            textPrinter->printerTemplate.currentY = textPrinter->printerTemplate.y;
+            return 2;
+        case EXT_CTRL_CODE_PAUSE_MUSIC:
+            m4aMPlayStop(&gMPlayInfo_BGM);
+            return 2;
+        case EXT_CTRL_CODE_RESUME_MUSIC:
+            m4aMPlayContinue(&gMPlayInfo_BGM);
+            return 2;
+        case EXT_CTRL_CODE_CLEAR:
+            width = *textPrinter->printerTemplate.currentChar;
+            textPrinter->printerTemplate.currentChar++;
+            if (width > 0)
             {
-            case EXT_CTRL_CODE_COLOR:
-                textPrinter->printerTemplate.fgColor = *textPrinter->printerTemplate.currentChar;
-                textPrinter->printerTemplate.currentChar++;
-                GenerateFontHalfRowLookupTable(textPrinter->printerTemplate.fgColor, textPrinter->printerTemplate.bgColor, textPrinter->printerTemplate.shadowColor);
-                return 2;
-            case EXT_CTRL_CODE_HIGHLIGHT:
-                textPrinter->printerTemplate.bgColor = *textPrinter->printerTemplate.currentChar;
-                textPrinter->printerTemplate.currentChar++;
-                GenerateFontHalfRowLookupTable(textPrinter->printerTemplate.fgColor, textPrinter->printerTemplate.bgColor, textPrinter->printerTemplate.shadowColor);
-                return 2;
-            case EXT_CTRL_CODE_SHADOW:
-                textPrinter->printerTemplate.shadowColor = *textPrinter->printerTemplate.currentChar;
-                textPrinter->printerTemplate.currentChar++;
-                GenerateFontHalfRowLookupTable(textPrinter->printerTemplate.fgColor, textPrinter->printerTemplate.bgColor, textPrinter->printerTemplate.shadowColor);
-                return 2;
-            case EXT_CTRL_CODE_COLOR_HIGHLIGHT_SHADOW:
-                textPrinter->printerTemplate.fgColor = *textPrinter->printerTemplate.currentChar;
-                textPrinter->printerTemplate.currentChar++;
-                textPrinter->printerTemplate.bgColor = *textPrinter->printerTemplate.currentChar;
-                textPrinter->printerTemplate.currentChar++;
-                textPrinter->printerTemplate.shadowColor = *textPrinter->printerTemplate.currentChar;
-                textPrinter->printerTemplate.currentChar++;
-                GenerateFontHalfRowLookupTable(textPrinter->printerTemplate.fgColor, textPrinter->printerTemplate.bgColor, textPrinter->printerTemplate.shadowColor);
-                return 2;
-            case EXT_CTRL_CODE_PALETTE:
-                textPrinter->printerTemplate.currentChar++;
-                return 2;
-            case EXT_CTRL_CODE_FONT:
-                subStruct->glyphId = *textPrinter->printerTemplate.currentChar;
-                textPrinter->printerTemplate.currentChar++;
-                return 2;
-            case EXT_CTRL_CODE_RESET_SIZE:
-                return 2;
-            case EXT_CTRL_CODE_PAUSE:
-                textPrinter->delayCounter = *textPrinter->printerTemplate.currentChar;
-                textPrinter->printerTemplate.currentChar++;
-                textPrinter->state = 6;
-                return 2;
-            case EXT_CTRL_CODE_PAUSE_UNTIL_PRESS:
-                textPrinter->state = 1;
-                if (gTextFlags.autoScroll)
-                    subStruct->autoScrollDelay = 0;
-                return 3;
-            case EXT_CTRL_CODE_WAIT_SE:
-                textPrinter->state = 5;
-                return 3;
-            case EXT_CTRL_CODE_PLAY_BGM:
-                currChar = *textPrinter->printerTemplate.currentChar;
-                textPrinter->printerTemplate.currentChar++;
-                currChar |= *textPrinter->printerTemplate.currentChar << 8;
-                textPrinter->printerTemplate.currentChar++;
-                PlayBGM(currChar);
-                return 2;
-            case EXT_CTRL_CODE_ESCAPE:
-                currChar = *textPrinter->printerTemplate.currentChar | 0x100;
-                textPrinter->printerTemplate.currentChar++;
-                break;
-            case EXT_CTRL_CODE_PLAY_SE:
-                currChar = *textPrinter->printerTemplate.currentChar;
-                textPrinter->printerTemplate.currentChar++;
-                currChar |= (*textPrinter->printerTemplate.currentChar << 8);
-                textPrinter->printerTemplate.currentChar++;
-                PlaySE(currChar);
-                return 2;
-            case EXT_CTRL_CODE_SHIFT_TEXT:
-                textPrinter->printerTemplate.currentX = textPrinter->printerTemplate.x + *textPrinter->printerTemplate.currentChar;
-                textPrinter->printerTemplate.currentChar++;
-                return 2;
-            case EXT_CTRL_CODE_SHIFT_DOWN:
-                textPrinter->printerTemplate.currentY = textPrinter->printerTemplate.y + *textPrinter->printerTemplate.currentChar;
-                textPrinter->printerTemplate.currentChar++;
-                return 2;
-            case EXT_CTRL_CODE_FILL_WINDOW:
-                FillWindowPixelBuffer(textPrinter->printerTemplate.windowId, PIXEL_FILL(textPrinter->printerTemplate.bgColor));
-                textPrinter->printerTemplate.currentX = textPrinter->printerTemplate.x;
-                textPrinter->printerTemplate.currentY = textPrinter->printerTemplate.y;
-                return 2;
-            case EXT_CTRL_CODE_PAUSE_MUSIC:
-                m4aMPlayStop(&gMPlayInfo_BGM);
-                return 2;
-            case EXT_CTRL_CODE_RESUME_MUSIC:
-                m4aMPlayContinue(&gMPlayInfo_BGM);
-                return 2;
-            case EXT_CTRL_CODE_CLEAR:
-                width = *textPrinter->printerTemplate.currentChar;
+                ClearTextSpan(textPrinter, width);
+                textPrinter->printerTemplate.currentX += width;
+                return 0;
+            }
+            return 2;
+        case EXT_CTRL_CODE_SKIP:
+            textPrinter->printerTemplate.currentX = *textPrinter->printerTemplate.currentChar + textPrinter->printerTemplate.x;
+            textPrinter->printerTemplate.currentChar++;
+            return 2;
+        case EXT_CTRL_CODE_CLEAR_TO:
+            {
+                widthHelper = *textPrinter->printerTemplate.currentChar;
+                widthHelper += textPrinter->printerTemplate.x;
                 textPrinter->printerTemplate.currentChar++;
+                width = widthHelper - textPrinter->printerTemplate.currentX;
                 if (width > 0)
                 {
                     ClearTextSpan(textPrinter, width);
                     textPrinter->printerTemplate.currentX += width;
                     return 0;
                 }
-                return 2;
-            case EXT_CTRL_CODE_SKIP:
-                textPrinter->printerTemplate.currentX = *textPrinter->printerTemplate.currentChar + textPrinter->printerTemplate.x;
-                textPrinter->printerTemplate.currentChar++;
-                return 2;
-            case EXT_CTRL_CODE_CLEAR_TO:
-                {
-                    widthHelper = *textPrinter->printerTemplate.currentChar;
-                    widthHelper += textPrinter->printerTemplate.x;
-                    textPrinter->printerTemplate.currentChar++;
-                    width = widthHelper - textPrinter->printerTemplate.currentX;
-                    if (width > 0)
-                    {
-                        ClearTextSpan(textPrinter, width);
-                        textPrinter->printerTemplate.currentX += width;
-                        return 0;
-                    }
-                }
-                return 2;
-            case EXT_CTRL_CODE_MIN_LETTER_SPACING:
-                textPrinter->minLetterSpacing = *textPrinter->printerTemplate.currentChar++;
-                return 2;
-            case EXT_CTRL_CODE_JPN:
-                textPrinter->japanese = TRUE;
-                return 2;
-            case EXT_CTRL_CODE_ENG:
-                textPrinter->japanese = FALSE;
-                return 2;
             }
-            break;
-        case CHAR_PROMPT_CLEAR:
-            textPrinter->state = 2;
-            TextPrinterInitDownArrowCounters(textPrinter);
-            return 3;
-        case CHAR_PROMPT_SCROLL:
-            textPrinter->state = 3;
-            TextPrinterInitDownArrowCounters(textPrinter);
-            return 3;
-        case CHAR_EXTRA_SYMBOL:
-            currChar = *textPrinter->printerTemplate.currentChar | 0x100;
-            textPrinter->printerTemplate.currentChar++;
-            break;
-        case CHAR_KEYPAD_ICON:
-            currChar = *textPrinter->printerTemplate.currentChar++;
-            gUnknown_03002F90.width = DrawKeypadIcon(textPrinter->printerTemplate.windowId, currChar, textPrinter->printerTemplate.currentX, textPrinter->printerTemplate.currentY);
-            textPrinter->printerTemplate.currentX += gUnknown_03002F90.width + textPrinter->printerTemplate.letterSpacing;
-            return 0;
-        case EOS:
-            return 1;
+            return 2;
+        case EXT_CTRL_CODE_MIN_LETTER_SPACING:
+            textPrinter->minLetterSpacing = *textPrinter->printerTemplate.currentChar++;
+            return 2;
+        case EXT_CTRL_CODE_JPN:
+            textPrinter->japanese = TRUE;
+            return 2;
+        case EXT_CTRL_CODE_ENG:
+            textPrinter->japanese = FALSE;
+            return 2;
         }
+        break;
+    case CHAR_PROMPT_CLEAR:
+        textPrinter->state = 2;
+        TextPrinterInitDownArrowCounters(textPrinter);
+        return 3;
+    case CHAR_PROMPT_SCROLL:
+        textPrinter->state = 3;
+        TextPrinterInitDownArrowCounters(textPrinter);
+        return 3;
+    case CHAR_EXTRA_SYMBOL:
+        currChar = *textPrinter->printerTemplate.currentChar | 0x100;
+        textPrinter->printerTemplate.currentChar++;
+        break;
+    case CHAR_KEYPAD_ICON:
+        currChar = *textPrinter->printerTemplate.currentChar++;
+        gUnknown_03002F90.width = DrawKeypadIcon(textPrinter->printerTemplate.windowId, currChar, textPrinter->printerTemplate.currentX, textPrinter->printerTemplate.currentY);
+        textPrinter->printerTemplate.currentX += gUnknown_03002F90.width + textPrinter->printerTemplate.letterSpacing;
+        return 0;
+    case EOS:
+        return 1;
+    }
+
+    if (subStruct->glyphId != 6)
+        DecompressGlyphCached(subStruct->glyphId, currChar, textPrinter->japanese);
 
-        switch (subStruct->glyphId)
+    CopyGlyphToWindow(textPrinter);
+
+    if (textPrinter->minLetterSpacing)
+    {
+        textPrinter->printerTemplate.currentX += gUnknown_03002F90.width;
+        width = textPrinter->minLetterSpacing - gUnknown_03002F90.width;
+        if (width > 0)
         {
-        case 0:
-            DecompressGlyphFont0(currChar, textPrinter->japanese);
-            break;
-        case 1:
-            DecompressGlyphFont1(currChar, textPrinter->japanese);
-            break;
-        case 2:
-        case 3:
-        case 4:
-        case 5:
-            DecompressGlyphFont2(currChar, textPrinter->japanese);
-            break;
-        case 7:
-            DecompressGlyphFont7(currChar, textPrinter->japanese);
-            break;
-        case 8:
-            DecompressGlyphFont8(currChar, textPrinter->japanese);
-            break;
-        case 6:
-            break;
+            ClearTextSpan(textPrinter, width);
+            textPrinter->printerTemplate.currentX += width;
         }
+    }
+    else if (textPrinter->japanese)
+        textPrinter->printerTemplate.currentX += (gUnknown_03002F90.width + textPrinter->printerTemplate.letterSpacing);
+    else
+        textPrinter->printerTemplate.currentX += gUnknown_03002F90.width;
+    return 0;
+}
+
+// Characters an instant printer renders per call before handing control back,
+// so that the 0x400 call limit in AddTextPrinter and RunTextPrinters still
+// bounds a string that's missing its EOS.
+#define INSTANT_TEXT_MAX_CHARS 32
+
+// Instant printers never wait between characters, so instead of going back
+// through RenderFont and the font function for every glyph, keep rendering
+// until the text ends or something puts the printer in another state.
+static u16 RenderInstantText(struct TextPrinter *textPrinter)
+{
+    u16 ret;
+    u32 count = 0;
+
+    do
+    {
+        ret = RenderTextCharacter(textPrinter);
+    } while ((ret == 0 || ret == 2) && textPrinter->state == 0 && ++count < INSTANT_TEXT_MAX_CHARS);
+
+    return ret;
+}
 
-        CopyGlyphToWindow(textPrinter);
+u16 RenderText(struct TextPrinter *textPrinter)
+{
+    struct TextPrinterSubStruct *subStruct = (struct TextPrinterSubStruct *)(&textPrinter->subStructFields);
 
-        if (textPrinter->minLetterSpacing)
+    switch (textPrinter->state)
+    {
+    case 0:
+        if ((JOY_HELD(A_BUTTON | B_BUTTON)) && subStruct->hasPrintBeenSpedUp)
+            textPrinter->delayCounter = 0;
+
+        if (textPrinter->delayCounter && textPrinter->textSpeed)
         {
-            textPrinter->printerTemplate.currentX += gUnknown_03002F90.width;
-            width = textPrinter->minLetterSpacing - gUnknown_03002F90.width;
-            if (width > 0)
+            textPrinter->delayCounter--;
+            if (gTextFlags.canABSpeedUpPrint && (JOY_NEW(A_BUTTON | B_BUTTON)))
             {
-                ClearTextSpan(textPrinter, width);
-                textPrinter->printerTemplate.currentX += width;
+                subStruct->hasPrintBeenSpedUp = TRUE;
+                textPrinter->delayCounter = 0;
             }
+            return 3;
         }
-        else if (textPrinter->japanese)
-            textPrinter->printerTemplate.currentX += (gUnknown_03002F90.width + textPrinter->printerTemplate.letterSpacing);
+
+        if (!(gBattleTypeFlags & BATTLE_TYPE_RECORDED) && gTextFlags.autoScroll)
+            textPrinter->delayCounter = 3;
         else
-            textPrinter->printerTemplate.currentX += gUnknown_03002F90.width;
-        return 0;
+            textPrinter->delayCounter = textPrinter->textSpeed;
+
+        if (textPrinter->isInstant)
+            return RenderInstantText(textPrinter);
+        return RenderTextCharacter(textPrinter);
     case 1:
         if (TextPrinterWait(textPrinter))
             textPrinter->state = 0;
@@ -1378,11 +1585,21 @@ u32 (*GetFontWidthFunc(u8 glyphId))(u16, bool32)
     return NULL;
 }
 
-s32 GetStringWidth(u8 fontId, const u8 *str, s16 letterSpacing)
+static inline u32 GetGlyphWidthFromTable(const struct GlyphWidthTable *table, u16 glyphId, bool32 isJapanese)
+{
+    const u8 *widths = isJapanese ? table->japanese : table->latin;
+
+    if (widths == NULL)
+        return isJapanese ? table->japaneseWidth : table->latinWidth;
+    return widths[glyphId];
+}
+
+// Sets *usesBuffers if the width depends on string buffers the placeholders point at.
+static s32 ComputeStringWidth(u8 fontId, const u8 *str, s16 letterSpacing, bool32 *usesBuffers)
 {
     bool8 isJapanese;
     int minGlyphWidth;
-    u32 (*func)(u16 glyphId, bool32 isJapanese);
+    const struct GlyphWidthTable *table;
     s32 result;
     int localLetterSpacing;
     u32 lineWidth;
@@ -1393,9 +1610,9 @@ s32 GetStringWidth(u8 fontId, const u8 *str, s16 letterSpacing)
     isJapanese = 0;
     minGlyphWidth = 0;
 
-    func = GetFontWidthFunc(fontId);
-    if (func == NULL)
+    if (fontId >= ARRAY_COUNT(sGlyphWidthTables))
         return 0;
+    table = &sGlyphWidthTables[fontId];
 
     if (letterSpacing == -1)
         localLetterSpacing = GetFontAttribute(fontId, FONTATTR_LETTER_SPACING);
@@ -1416,6 +1633,7 @@ s32 GetStringWidth(u8 fontId, const u8 *str, s16 letterSpacing)
             lineWidth = 0;
             break;
         case PLACEHOLDER_BEGIN:
+            *usesBuffers = TRUE;
             switch (*++str)
             {
                 case PLACEHOLDER_ID_STRING_VAR_1:
@@ -1431,11 +1649,12 @@ s32 GetStringWidth(u8 fontId, const u8 *str, s16 letterSpacing)
                     return 0;
             }
         case CHAR_DYNAMIC:
+            *usesBuffers = TRUE;
             if (bufferPointer == NULL)
                 bufferPointer = DynamicPlaceholderTextUtil_GetPlaceholderPtr(*++str);
             while (*bufferPointer != EOS)
             {
-                glyphWidth = func(*bufferPointer++, isJapanese);
+                glyphWidth = GetGlyphWidthFromTable(table, *bufferPointer++, isJapanese);
                 if (minGlyphWidth > 0)
                 {
                     if (glyphWidth < minGlyphWidth)
@@ -1470,9 +1689,9 @@ s32 GetStringWidth(u8 fontId, const u8 *str, s16 letterSpacing)
                 ++str;
                 break;
             case EXT_CTRL_CODE_FONT:
-                func = GetFontWidthFunc(*++str);
-                if (func == NULL)
+                if (*++str >= ARRAY_COUNT(sGlyphWidthTables))
                     return 0;
+                table = &sGlyphWidthTables[*str];
                 if (letterSpacing == -1)
                     localLetterSpacing = GetFontAttribute(*str, FONTATTR_LETTER_SPACING);
                 break;
@@ -1507,7 +1726,7 @@ s32 GetStringWidth(u8 fontId, const u8 *str, s16 letterSpacing)
         case CHAR_KEYPAD_ICON:
         case CHAR_EXTRA_SYMBOL:
             if (*str == CHAR_EXTRA_SYMBOL)
-                glyphWidth = func(*++str | 0x100, isJapanese);
+                glyphWidth = GetGlyphWidthFromTable(table, *++str | 0x100, isJapanese);
             else
                 glyphWidth = GetKeypadIconWidth(*++str);
 
@@ -1528,7 +1747,7 @@ s32 GetStringWidth(u8 fontId, const u8 *str, s16 letterSpacing)
         case CHAR_PROMPT_CLEAR:
             break;
         default:
-            glyphWidth = func(*str, isJapanese);
+            glyphWidth = GetGlyphWidthFromTable(table, *str, isJapanese);
             if (minGlyphWidth > 0)
             {
                 if (glyphWidth < minGlyphWidth)
@@ -1552,6 +1771,31 @@ s32 GetStringWidth(u8 fontId, const u8 *str, s16 letterSpacing)
         return width;
 }
 
+s32 GetStringWidth(u8 fontId, const u8 *str, s16 letterSpacing)
+{
+    struct StringWidthCacheEntry *entry;
+    bool32 usesBuffers = FALSE;
+    s32 width;
+
+    // Strings in RAM can change under the same address.
+    if ((u32)str < IWRAM_END)
+        return ComputeStringWidth(fontId, str, letterSpacing, &usesBuffers);
+
+    entry = &sStringWidthCache[(((u32)str >> 1) ^ ((u32)str >> 7) ^ fontId) % STRING_WIDTH_CACHE_SIZE];
+    if (entry->str == str && entry->fontId == fontId && entry->letterSpacing == letterSpacing)
+        return entry->width;
+
+    width = ComputeStringWidth(fontId, str, letterSpacing, &usesBuffers);
+    if (!usesBuffers)
+    {
+        entry->str = str;
+        entry->fontId = fontId;
+        entry->letterSpacing = letterSpacing;
+        entry->width = width;
+    }
+    return width;
+}
+
 u8 RenderTextFont9(u8 *pixels, u8 fontId, u8 *str)
 {
     u8 shadowColor;
@@ -355,6 +355,14 @@ struct GlyphWidthFunc
     u32 (*func)(u16 glyphId, bool32 isJapanese);
 };
 
+struct GlyphWidthTable
+{
+    const u8 *latin;    // NULL if every glyph is latinWidth wide
+    const u8 *japanese; // NULL if every glyph is japaneseWidth wide
+    u8 latinWidth;
+    u8 japaneseWidth;
+};
+
 struct KeypadIcon
 {
     u16 tileOffset;
@@ -379,6 +387,12 @@ struct Struct_03002F90
     u8 height;
 };
 
+struct GlyphCacheStats
+{
+    u32 hits;
+    u32 misses;
+};
+
 extern TextFlags gTextFlags;
 
 extern bool8 gUnknown_03002F84;
@@ -395,6 +409,7 @@ void GenerateFontHalfRowLookupTable(u8 fgColor, u8 bgColor, u8 shadowColor);
 void SaveTextColors(u8 *fgColor, u8 *bgColor, u8 *shadowColor);
 void RestoreTextColors(u8 *fgColor, u8 *bgColor, u8 *shadowColor);
 void DecompressGlyphTile(const void *src_, void *dest_);
+void GetGlyphCacheStats(struct GlyphCacheStats *stats);
 u8 GetLastTextColor(u8 colorType);
 void CopyGlyphToWindow(struct TextPrinter *x);
 void ClearTextSpan(struct TextPrinter *textPrinter, u32 width);
@@ -3,6 +3,7 @@
 #include "malloc.h"
 #include "bg.h"
 #include "blit.h"
+#include "main.h"
 
 u32 filler_03002F58;
 u32 filler_03002F5C;
@@ -20,6 +21,8 @@ EWRAM_DATA static u16 sWindowSize = 0;
 
 static u8 GetNumActiveWindowsOnBg(u8 bgId);
 static u8 GetNumActiveWindowsOnBg8Bit(u8 bgId);
+static void ResetWindowDirtyTiles(u8 windowId);
+static void CopyWindowDirtyTilesToVram(u8 windowId);
 
 static const struct WindowTemplate sDummyWindowTemplate = DUMMY_WIN_TEMPLATE;
 
@@ -48,6 +51,10 @@ bool16 InitWindows(const struct WindowTemplate *templates)
     {
         gWindows[i].window = sDummyWindowTemplate;
         gWindows[i].tileData = NULL;
+        gWindows[i].dirtyTileStart = 0;
+        gWindows[i].dirtyTileEnd = 0;
+        gWindows[i].fullCopyQueued = FALSE;
+        gWindows[i].tileDataShared = FALSE;
     }
 
     for (i = 0, allocatedBaseBlock = 0, bgLayer = templates[i].bg; bgLayer != 0xFF && i < 0x20; ++i, bgLayer = templates[i].bg)
@@ -96,6 +103,7 @@ bool16 InitWindows(const struct WindowTemplate *templates)
 
         gWindows[i].tileData = allocatedTilemapBuffer;
         gWindows[i].window = templates[i];
+        ResetWindowDirtyTiles(i);
 
         if (gUnneededFireRedVariable == 1)
         {
@@ -170,6 +178,7 @@ u16 AddWindow(const struct WindowTemplate *template)
 
     gWindows[win].tileData = allocatedTilemapBuffer;
     gWindows[win].window = *template;
+    ResetWindowDirtyTiles(win);
 
     if (gUnneededFireRedVariable == 1)
     {
@@ -207,6 +216,7 @@ int AddWindowWithoutTileMap(const struct WindowTemplate *template)
     }
 
     gWindows[win].window = *template;
+    ResetWindowDirtyTiles(win);
 
     if (gUnneededFireRedVariable == 1)
     {
@@ -270,7 +280,6 @@ void FreeAllWindowBuffers(void)
 void CopyWindowToVram(u8 windowId, u8 mode)
 {
     struct Window windowLocal = gWindows[windowId];
-    u16 windowSize = 32 * (windowLocal.window.width * windowLocal.window.height);
 
     switch (mode)
     {
@@ -278,15 +287,130 @@ void CopyWindowToVram(u8 windowId, u8 mode)
         CopyBgTilemapBufferToVram(windowLocal.window.bg);
         break;
     case 2:
-        LoadBgTiles(windowLocal.window.bg, windowLocal.tileData, windowSize, windowLocal.window.baseBlock);
+        CopyWindowDirtyTilesToVram(windowId);
         break;
     case 3:
-        LoadBgTiles(windowLocal.window.bg, windowLocal.tileData, windowSize, windowLocal.window.baseBlock);
+        CopyWindowDirtyTilesToVram(windowId);
         CopyBgTilemapBufferToVram(windowLocal.window.bg);
         break;
     }
 }
 
+// A new window has never been uploaded, so all of its tiles start out dirty.
+static void ResetWindowDirtyTiles(u8 windowId)
+{
+    gWindows[windowId].dirtyTileStart = 0;
+    gWindows[windowId].dirtyTileEnd = gWindows[windowId].window.width * gWindows[windowId].window.height;
+    gWindows[windowId].copyFrame = gMain.vblankCounter1 - 1;
+    gWindows[windowId].fullCopyQueued = FALSE;
+    gWindows[windowId].tileDataShared = FALSE;
+}
+
+// Uploads only the tiles written since the last copy. Once the pixel buffer has
+// been handed out through GetWindowAttribute its writes can't be tracked, so
+// such windows are always uploaded whole.
+static void CopyWindowDirtyTilesToVram(u8 windowId)
+{
+    struct Window *window = &gWindows[windowId];
+    u16 size = window->window.width * window->window.height;
+    u16 start = window->dirtyTileStart;
+    u16 end = window->dirtyTileEnd;
+
+    if (window->tileDataShared)
+    {
+        start = 0;
+        end = size;
+    }
+
+    if (start >= end)
+        return;
+
+    // If the DMA queue is full the tiles stay dirty, so the next copy retries them.
+    if (LoadBgTiles(window->window.bg, window->tileData + 32 * start, 32 * (end - start), window->window.baseBlock + start) == (u16)-1)
+        return;
+
+    window->dirtyTileStart = 0;
+    window->dirtyTileEnd = 0;
+
+    // A full copy queued earlier this frame still covers the whole window.
+    if (window->copyFrame != gMain.vblankCounter1)
+        window->fullCopyQueued = FALSE;
+    if (start == 0 && end == size)
+        window->fullCopyQueued = TRUE;
+    window->copyFrame = gMain.vblankCounter1;
+}
+
+void MarkWindowTilesDirty(u8 windowId, u16 firstTile, u16 numTiles)
+{
+    struct Window *window = &gWindows[windowId];
+    u16 size = window->window.width * window->window.height;
+    u16 end;
+
+    if (numTiles == 0 || firstTile >= size)
+        return;
+
+    end = firstTile + numTiles;
+    if (end > size)
+        end = size;
+
+    // The DMA queued by a copy earlier this frame only reads the buffer during
+    // VBlank, so anything drawn before then used to reach VRAM with the full
+    // window copy. Queue that full copy once, on the first write after a copy,
+    // and let every later write this frame ride along with it.
+    if (window->copyFrame == gMain.vblankCounter1)
+    {
+        if (window->fullCopyQueued)
+            return;
+
+        if (LoadBgTiles(window->window.bg, window->tileData, 32 * size, window->window.baseBlock) != (u16)-1)
+        {
+            window->dirtyTileStart = 0;
+            window->dirtyTileEnd = 0;
+            window->fullCopyQueued = TRUE;
+            return;
+        }
+    }
+
+    if (window->dirtyTileStart == window->dirtyTileEnd)
+    {
+        window->dirtyTileStart = firstTile;
+        window->dirtyTileEnd = end;
+    }
+    else
+    {
+        if (firstTile < window->dirtyTileStart)
+            window->dirtyTileStart = firstTile;
+        if (end > window->dirtyTileEnd)
+            window->dirtyTileEnd = end;
+    }
+}
+
+// Tiles are stored row by row, so a rect dirties everything from its top left
+// tile to its bottom right one.
+void MarkWindowPixelRectDirty(u8 windowId, u16 x, u16 y, u16 width, u16 height)
+{
+    u16 windowWidth = gWindows[windowId].window.width;
+    u16 windowHeight = gWindows[windowId].window.height;
+    u16 left, top, right, bottom;
+
+    if (width == 0 || height == 0)
+        return;
+
+    left = x / 8;
+    top = y / 8;
+    right = (x + width - 1) / 8;
+    bottom = (y + height - 1) / 8;
+
+    if (left >= windowWidth || top >= windowHeight)
+        return;
+    if (right >= windowWidth)
+        right = windowWidth - 1;
+    if (bottom >= windowHeight)
+        bottom = windowHeight - 1;
+
+    MarkWindowTilesDirty(windowId, top * windowWidth + left, (bottom - top) * windowWidth + right - left + 1);
+}
+
 void CopyWindowRectToVram(u32 windowId, u32 mode, u32 x, u32 y, u32 w, u32 h)
 {
     struct Window windowLocal;
@@ -413,6 +537,7 @@ void BlitBitmapRectToWindow(u8 windowId, const u8 *pixels, u16 srcX, u16 srcY, u
     destRect.height = 8 * gWindows[windowId].window.height;
 
     BlitBitmapRect4Bit(&sourceRect, &destRect, srcX, srcY, destX, destY, rectWidth, rectHeight, 0);
+    MarkWindowPixelRectDirty(windowId, destX, destY, rectWidth, rectHeight);
 }
 
 static void BlitBitmapRectToWindowWithColorKey(u8 windowId, const u8 *pixels, u16 srcX, u16 srcY, u16 srcWidth, int srcHeight, u16 destX, u16 destY, u16 rectWidth, u16 rectHeight, u8 colorKey)
@@ -429,6 +554,7 @@ static void BlitBitmapRectToWindowWithColorKey(u8 windowId, const u8 *pixels, u1
     destRect.height = 8 * gWindows[windowId].window.height;
 
     BlitBitmapRect4Bit(&sourceRect, &destRect, srcX, srcY, destX, destY, rectWidth, rectHeight, colorKey);
+    MarkWindowPixelRectDirty(windowId, destX, destY, rectWidth, rectHeight);
 }
 
 void FillWindowPixelRect(u8 windowId, u8 fillValue, u16 x, u16 y, u16 width, u16 height)
@@ -440,14 +566,21 @@ void FillWindowPixelRect(u8 windowId, u8 fillValue, u16 x, u16 y, u16 width, u16
     pixelRect.height = 8 * gWindows[windowId].window.height;
 
     FillBitmapRect4Bit(&pixelRect, x, y, width, height, fillValue);
+    MarkWindowPixelRectDirty(windowId, x, y, width, height);
 }
 
 void CopyToWindowPixelBuffer(u8 windowId, const void *src, u16 size, u16 tileOffset)
 {
     if (size != 0)
+    {
         CpuCopy16(src, gWindows[windowId].tileData + (0x20 * tileOffset), size);
+        MarkWindowTilesDirty(windowId, tileOffset, (size + 0x1F) / 0x20);
+    }
     else
+    {
         LZ77UnCompWram(src, gWindows[windowId].tileData + (0x20 * tileOffset));
+        MarkWindowTilesDirty(windowId, tileOffset, gWindows[windowId].window.width * gWindows[windowId].window.height);
+    }
 }
 
 // Sets all pixels within the window to the fillValue color.
@@ -455,6 +588,7 @@ void FillWindowPixelBuffer(u8 windowId, u8 fillValue)
 {
     int fillSize = gWindows[windowId].window.width * gWindows[windowId].window.height;
     CpuFastFill8(fillValue, gWindows[windowId].tileData, 0x20 * fillSize);
+    MarkWindowTilesDirty(windowId, 0, fillSize);
 }
 
 #define MOVE_TILES_DOWN(a)                                                      \
@@ -524,6 +658,8 @@ void ScrollWindow(u8 windowId, u8 direction, u8 distance, u8 fillValue)
     case 2:
         break;
     }
+
+    MarkWindowTilesDirty(windowId, 0, window.width * window.height);
 }
 
 void CallWindowFunction(u8 windowId, void ( *func)(u8, u8, u8, u8, u8, u8))
@@ -550,6 +686,7 @@ bool8 SetWindowAttribute(u8 windowId, u8 attributeId, u32 value)
         return FALSE;
     case WINDOW_TILE_DATA:
         gWindows[windowId].tileData = (u8*)(value);
+        gWindows[windowId].tileDataShared = TRUE;
         return TRUE;
     case WINDOW_BG:
     case WINDOW_WIDTH:
@@ -578,6 +715,7 @@ u32 GetWindowAttribute(u8 windowId, u8 attributeId)
     case WINDOW_BASE_BLOCK:
         return (u32)gWindows[windowId].window.baseBlock;
     case WINDOW_TILE_DATA:
+        gWindows[windowId].tileDataShared = TRUE;
         return (u32)(gWindows[windowId].tileData);
     default:
         return 0;
@@ -642,6 +780,7 @@ u16 AddWindow8Bit(const struct WindowTemplate *template)
     }
     gWindows[windowId].tileData = memAddress;
     gWindows[windowId].window = *template;
+    ResetWindowDirtyTiles(windowId);
     return windowId;
 }
 
@@ -41,6 +41,11 @@ struct Window
 {
     struct WindowTemplate window;
     u8 *tileData;
+    u16 dirtyTileStart; // tiles changed since the last copy to VRAM
+    u16 dirtyTileEnd;
+    u32 copyFrame;      // vblankCounter1 when tiles were last queued for VRAM
+    bool8 fullCopyQueued; // the copy queued in copyFrame covers the whole window
+    bool8 tileDataShared;
 };
 
 // Mode parameter for funcs below
@@ -58,6 +63,8 @@ void RemoveWindow(u8 windowId);
 void FreeAllWindowBuffers(void);
 void CopyWindowToVram(u8 windowId, u8 mode);
 void CopyWindowRectToVram(u32 windowId, u32 mode, u32 x, u32 y, u32 w, u32 h);
+void MarkWindowTilesDirty(u8 windowId, u16 firstTile, u16 numTiles);
+void MarkWindowPixelRectDirty(u8 windowId, u16 x, u16 y, u16 width, u16 height);
 void PutWindowTilemap(u8 windowId);
 void PutWindowRectTilemapOverridePalette(u8 windowId, u8 x, u8 y, u8 width, u8 height, u8 palette);
 void ClearWindowTilemap(u8 windowId);
@@ -33,5 +33,6 @@ void SetCameraPanning(s16 a, s16 b);
 void InstallCameraPanAheadCallback(void);
 void UpdateCameraPanning(void);
 void FieldUpdateBgTilemapScroll(void);
+void FieldCopyDirtyTilemapRowsToVram(void);
 
 #endif //GUARD_FIELD_CAMERA_H
@@ -122,6 +122,17 @@ struct Pokemon
     u16 spDefense;
 };
 
+// The secure substructs of a BoxPokemon, decrypted and in their canonical order.
+// Use DecodeBoxMon/EncodeBoxMon when reading or writing many encrypted fields at
+// once, instead of paying GetBoxMonData's decrypt and checksum for every field.
+struct DecodedBoxMon
+{
+    struct PokemonSubstruct0 substruct0;
+    struct PokemonSubstruct1 substruct1;
+    struct PokemonSubstruct2 substruct2;
+    struct PokemonSubstruct3 substruct3;
+};
+
 struct Unknown_806F160_Struct
 {
     u32 field_0_0:4;
@@ -320,6 +331,8 @@ u32 GetBoxMonData();
 
 void SetMonData(struct Pokemon *mon, s32 field, const void *dataArg);
 void SetBoxMonData(struct BoxPokemon *boxMon, s32 field, const void *dataArg);
+bool8 DecodeBoxMon(struct BoxPokemon *boxMon, struct DecodedBoxMon *decoded);
+void EncodeBoxMon(struct BoxPokemon *boxMon, const struct DecodedBoxMon *decoded);
 void CopyMon(void *dest, void *src, size_t size);
 u8 GiveMonToPlayer(struct Pokemon *mon);
 u8 SendMonToPC(struct Pokemon* mon);
@@ -34,4 +34,34 @@ u8 GetTaskCount(void);
 void SetWordTaskArg(u8 taskId, u8 dataElem, u32 value);
 u32 GetWordTaskArg(u8 taskId, u8 dataElem);
 
+#if DEBUG
+#define PROFILER_NUM_FUNCS 64
+#define PROFILER_NUM_FRAMES 32
+
+// Time spent in one task or sprite callback since the profiler was last
+// reset. The func of the entry collecting calls that didn't fit is NULL.
+struct ProfilerFuncStats
+{
+    const void *func;
+    u32 cycles;
+    u32 calls;
+};
+
+struct ProfilerFrameStats
+{
+    u32 taskCycles;
+    u32 spriteCycles;
+};
+
+extern bool8 gProfilerEnabled;
+
+void SetProfilerEnabled(bool8 enabled);
+void ResetProfiler(void);
+u16 ProfilerBegin(void);
+void ProfilerEnd(const void *func, u16 start, bool8 isSprite);
+u32 GetProfilerTopFuncs(struct ProfilerFuncStats *dest, u32 count);
+const struct ProfilerFrameStats *GetProfilerFrame(u32 age);
+bool8 SaveProfilerReport(void);
+#endif
+
 #endif // GUARD_TASK_H
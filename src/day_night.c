@@ -18,18 +18,29 @@
 #define TINT_DAY Q_8_8(1.0), Q_8_8(1.0), Q_8_8(1.0)
 #define TINT_NIGHT Q_8_8(0.6), Q_8_8(0.6), Q_8_8(0.92)
 
+// How many 16-color palettes are retinted per frame after a tint period change
+#define RETINT_SLOTS_PER_FRAME 8
+
 EWRAM_DATA u16 gPlttBufferPreDN[PLTT_BUFFER_SIZE] = {0};
 EWRAM_DATA struct PaletteOverride *gPaletteOverrides[4] = {NULL};
 
 static EWRAM_DATA struct {
     bool8 initialized:1;
-    bool8 retintPhase:1;
+    bool8 retintPhase:1; // stale palettes are still being retinted
     u8 timeOfDay;
     u16 prevTintPeriod; // tint period associated with currently drawn palettes
     u16 currTintPeriod; // tint period associated with currRGBTint
     u16 currRGBTint[3];
+    bool8 tintTablesValid;
+    u16 tintTablesRGB[3]; // tint the channel tables were built for
+    u32 tintableSlots;    // palettes loaded through the day/night loaders
+    u32 currentSlots;     // palettes tinted with the tint in the tables
 } sDNSystemControl = {0};
 
+// Tinted value of every 5-bit channel for the current tint, already shifted
+// into place, so tinting a color is three lookups.
+static EWRAM_DATA u16 sTintTables[3][32] = {0};
+
 #if DEBUG
 EWRAM_DATA bool8 gPaletteOverrideDisabled = 0;
 EWRAM_DATA s16 gDNPeriodOverride = 0;
@@ -113,7 +124,58 @@ void CopyCurrentDayOfWeekStringToVar1(void)
         StringCopy(gStringVar1, gText_None);
 }
 
-static void LoadPaletteOverrides(void)
+// Bits first..end-1 set, one per 16-color palette.
+static u32 GetPaletteSlotMask(u32 first, u32 end)
+{
+    u32 mask = (end >= 32) ? 0xFFFFFFFF : (1u << end) - 1;
+
+    if (first >= 32)
+        return 0;
+    return mask & ~((1u << first) - 1);
+}
+
+// Palettes touched by a load of size bytes at offset, or only the ones it
+// covers completely.
+static u32 GetPaletteSlotsInRange(u16 offset, u16 size, bool8 whole)
+{
+    if (whole)
+        return GetPaletteSlotMask((offset + 15) / 16, (offset + size / 2) / 16);
+    else
+        return GetPaletteSlotMask(offset / 16, (offset + size / 2 + 15) / 16);
+}
+
+// Non day/night loads fill gPlttBufferPreDN with black, which the retint
+// skips, so palettes they cover completely no longer need retinting.
+void ClearPaletteSlotsTintable(u16 offset, u16 size)
+{
+    u32 slots = GetPaletteSlotsInRange(offset, size, TRUE);
+
+    sDNSystemControl.tintableSlots &= ~slots;
+    sDNSystemControl.currentSlots &= ~slots;
+}
+
+static u32 GetOverriddenPaletteSlots(void)
+{
+    u8 i;
+    u32 slots = 0;
+
+    for (i = 0; i < ARRAY_COUNT(gPaletteOverrides); i++)
+    {
+        const struct PaletteOverride *curr = gPaletteOverrides[i];
+        if (curr != NULL)
+        {
+            while (curr->slot != PALOVER_LIST_TERM && curr->palette != NULL)
+            {
+                slots |= 1u << curr->slot;
+                curr++;
+            }
+        }
+    }
+
+    return slots;
+}
+
+static void LoadPaletteOverrides(u32 slots)
 {
     u8 i, j;
     const u16* src;
@@ -146,6 +208,12 @@ static void LoadPaletteOverrides(void)
         {
             while (curr->slot != PALOVER_LIST_TERM && curr->palette != NULL)
             {
+                if (!(slots & (1u << curr->slot)))
+                {
+                    curr++;
+                    continue;
+                }
+
                 if ((curr->startHour < curr->endHour && hour >= curr->startHour && hour < curr->endHour) ||
                     (curr->startHour > curr->endHour && (hour >= curr->startHour || hour < curr->endHour)))
                 {
@@ -197,6 +265,53 @@ bool32 LerpColors(u16 *rgbDest, const u16 *rgb1, const u16 *rgb2, u8 coeff)
     return ret;
 }
 
+static void UpdateTintTables(void)
+{
+    const u16 *tint = sDNSystemControl.currRGBTint;
+    s32 i, r, g, b;
+
+    if (sDNSystemControl.tintTablesValid &&
+        sDNSystemControl.tintTablesRGB[0] == tint[0] &&
+        sDNSystemControl.tintTablesRGB[1] == tint[1] &&
+        sDNSystemControl.tintTablesRGB[2] == tint[2])
+        return;
+
+    // Same math as TintPalette_CustomToneWithCopy.
+    // Everything tinted so far used the old tables.
+    sDNSystemControl.currentSlots = 0;
+
+    for (i = 0; i < 32; i++)
+    {
+        r = (u16)(tint[0] * i) >> 8;
+        g = (u16)(tint[1] * i) >> 8;
+        b = (u16)(tint[2] * i) >> 8;
+        sTintTables[0][i] = min(r, 31) << 0;
+        sTintTables[1][i] = min(g, 31) << 5;
+        sTintTables[2][i] = min(b, 31) << 10;
+    }
+
+    memcpy(sDNSystemControl.tintTablesRGB, tint, sizeof(sDNSystemControl.tintTablesRGB));
+    sDNSystemControl.tintTablesValid = TRUE;
+}
+
+static void TintPaletteWithCopy(const u16 *src, u16 *dest, u16 count, bool8 excludeZeroes)
+{
+    u32 color;
+
+    UpdateTintTables();
+
+    for (; count != 0; count--, src++, dest++)
+    {
+        color = *src;
+        if (excludeZeroes && color == RGB_BLACK)
+            continue;
+
+        *dest = sTintTables[0][color & 0x1F]
+              | sTintTables[1][(color >> 5) & 0x1F]
+              | sTintTables[2][(color >> 10) & 0x1F];
+    }
+}
+
 static void TintPaletteForDayNight(u16 offset, u16 size)
 {
     s8 hour, nextHour;
@@ -235,13 +350,15 @@ static void TintPaletteForDayNight(u16 offset, u16 size)
             LerpColors(sDNSystemControl.currRGBTint, sTimeOfDayTints[hour], sTimeOfDayTints[nextHour], hourPhase);
         }
 
-        TintPalette_CustomToneWithCopy(gPlttBufferPreDN + offset, gPlttBufferUnfaded + offset, size / 2, sDNSystemControl.currRGBTint[0], sDNSystemControl.currRGBTint[1], sDNSystemControl.currRGBTint[2], FALSE);
+        TintPaletteWithCopy(gPlttBufferPreDN + offset, gPlttBufferUnfaded + offset, size / 2, FALSE);
+        sDNSystemControl.currentSlots |= GetPaletteSlotsInRange(offset, size, TRUE);
     }
     else
     {
         CpuCopy16(gPlttBufferPreDN + offset, gPlttBufferUnfaded + offset, size);
     }
-    LoadPaletteOverrides();
+    sDNSystemControl.tintableSlots |= GetPaletteSlotsInRange(offset, size, FALSE);
+    LoadPaletteOverrides(0xFFFFFFFF);
 }
 
 void LoadCompressedPaletteDayNight(const void *src, u16 offset, u16 size)
@@ -265,6 +382,35 @@ void CheckClockForImmediateTimeEvents(void)
         RtcCalcLocalTimeFast();
 }
 
+// Retints up to RETINT_SLOTS_PER_FRAME palettes that weren't tinted with the
+// current tint yet. Overridden palettes are redone on every period change, since
+// the overrides that apply depend on the hour. Returns TRUE once none are left.
+static bool8 RetintStalePaletteSlots(void)
+{
+    u32 staleSlots;
+    u8 slot, count;
+    bool8 copyToFaded = (gWeatherPtr->palProcessingState != WEATHER_PAL_STATE_SCREEN_FADING_IN &&
+                         gWeatherPtr->palProcessingState != WEATHER_PAL_STATE_SCREEN_FADING_OUT);
+
+    UpdateTintTables();
+    staleSlots = (sDNSystemControl.tintableSlots | GetOverriddenPaletteSlots()) & ~sDNSystemControl.currentSlots;
+
+    for (slot = 0, count = 0; staleSlots != 0 && count < RETINT_SLOTS_PER_FRAME; slot++, staleSlots >>= 1)
+    {
+        if (!(staleSlots & 1))
+            continue;
+
+        TintPaletteWithCopy(gPlttBufferPreDN + slot * 16, gPlttBufferUnfaded + slot * 16, 16, TRUE);
+        LoadPaletteOverrides(1u << slot);
+        if (copyToFaded)
+            CpuCopy16(gPlttBufferUnfaded + slot * 16, gPlttBufferFaded + slot * 16, 32);
+        sDNSystemControl.currentSlots |= 1u << slot;
+        count++;
+    }
+
+    return staleSlots == 0;
+}
+
 void ProcessImmediateTimeEvents(void)
 {
     s8 hour, nextHour;
@@ -274,7 +420,7 @@ void ProcessImmediateTimeEvents(void)
 
     if (ShouldTintOverworld())
     {
-        if (sDNSystemControl.retintPhase == 0)
+        if (!sDNSystemControl.retintPhase)
         {
             if (gMapHeader.regionMapSectionId == MAPSEC_ILEX_FOREST)
             {
@@ -328,20 +474,14 @@ void ProcessImmediateTimeEvents(void)
                     LerpColors(sDNSystemControl.currRGBTint, sTimeOfDayTints[hour], sTimeOfDayTints[nextHour], hourPhase);
                 }
 
-                TintPalette_CustomToneWithCopy(gPlttBufferPreDN, gPlttBufferUnfaded, BG_PLTT_SIZE / 2, sDNSystemControl.currRGBTint[0], sDNSystemControl.currRGBTint[1], sDNSystemControl.currRGBTint[2], TRUE);
+                sDNSystemControl.currentSlots &= ~GetOverriddenPaletteSlots();
                 sDNSystemControl.retintPhase = 1;
             }
         }
-        else
-        {
+
+        // The clock isn't read again until every stale palette has been retinted.
+        if (sDNSystemControl.retintPhase && RetintStalePaletteSlots())
             sDNSystemControl.retintPhase = 0;
-            TintPalette_CustomToneWithCopy(gPlttBufferPreDN + (BG_PLTT_SIZE / 2), gPlttBufferUnfaded + (BG_PLTT_SIZE / 2), OBJ_PLTT_SIZE / 2, sDNSystemControl.currRGBTint[0], sDNSystemControl.currRGBTint[1], sDNSystemControl.currRGBTint[2], TRUE);
-            LoadPaletteOverrides();
-            
-            if (gWeatherPtr->palProcessingState != WEATHER_PAL_STATE_SCREEN_FADING_IN &&
-                gWeatherPtr->palProcessingState != WEATHER_PAL_STATE_SCREEN_FADING_OUT)
-                CpuCopy16(gPlttBufferUnfaded, gPlttBufferFaded, PLTT_SIZE);
-        }
     }
 
     if (sDNSystemControl.timeOfDay != timeOfDay)
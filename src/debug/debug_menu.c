@@ -17,6 +17,7 @@
 #include "item.h"
 #include "lottery_corner.h"
 #include "main.h"
+#include "malloc.h"
 #include "money.h"
 #include "overworld.h"
 #include "pokemon.h"
@@ -127,6 +128,12 @@ static void ReturnToPreviousMenu(u8 taskId, const struct DebugMenuBouncer *bounc
 static void DebugMenu_AddItem_ProcessInputNum(u8 taskId);
 static void DebugMenu_AddItem_ProcessInputCount(u8 taskId);
 static void DebugMenu_LottoNumber_ProcessInput(u8 taskId);
+static void DebugMenu_HeapStats(u8 taskId);
+static void DebugMenu_HeapStats_ProcessInput(u8 taskId);
+static void DebugMenu_SpriteTiles(u8 taskId);
+static void DebugMenu_SpriteTiles_ProcessInput(u8 taskId);
+static void DebugMenu_Profiler(u8 taskId);
+static void DebugMenu_Profiler_ProcessInput(u8 taskId);
 
 extern bool8 gPaletteTintDisabled;
 extern bool8 gPaletteOverrideDisabled;
@@ -158,6 +165,9 @@ static const u8 sText_TestBattleTransition[] = _("Test battle transition");
 static const u8 sText_CreateDaycareEgg[] = _("Create daycare egg");
 static const u8 sText_PoisonAllMons[] = _("Poison all Pokémon");
 static const u8 sText_FillThePC[] = _("Fill the PC");
+static const u8 sText_HeapStats[] = _("Heap stats");
+static const u8 sText_SpriteTiles[] = _("Sprite tiles");
+static const u8 sText_Profiler[] = _("Task/sprite profiler");
 static const u8 sText_100Or0CatchRate[] = _("Normal/100%/0% catch rate");
 static const u8 sText_ToggleForceShiny[] = _("Toggle forced shinies");
 static const u8 sText_ForcePartyEggsHatch[] = _("Hatch eggs in party");
@@ -179,6 +189,23 @@ static const u8 sText_ItemStatus[] = _("Item: {STR_VAR_1}\nCount: {STR_VAR_2}");
 static const u8 sText_ClockStatus[] = _("Time: {STR_VAR_1}");
 static const u8 sText_RespawnStatus[] = _("Respawn point:\n{STR_VAR_1}");
 static const u8 sText_LottoStatus[] = _("Lotto num:\n{STR_VAR_1}");
+static const u8 sText_HeapSummary[] = _("Live: {STR_VAR_1} in {STR_VAR_2}\nPeak: {STR_VAR_3}");
+static const u8 sText_HeapFreeSpace[] = _("Free: {STR_VAR_1}\nLargest: {STR_VAR_2}\nFrag.: {STR_VAR_3}%");
+static const u8 sText_HeapEvent[] = _("{STR_VAR_1}\nSize: {STR_VAR_2}\nPtr: {STR_VAR_3}");
+static const u8 sText_HeapEventCaller[] = _("From: {STR_VAR_1}");
+static const u8 sText_HeapAlloc[] = _("Alloc");
+static const u8 sText_HeapFree[] = _("Free");
+static const u8 sText_HeapFail[] = _("Failed alloc");
+static const u8 sText_HeapNoEvent[] = _("No event");
+static const u8 sText_HeapLeak[] = _("Leak {STR_VAR_1}\nSize: {STR_VAR_2}\nPtr: {STR_VAR_3}");
+static const u8 sText_HeapLeakOrigin[] = _("From: {STR_VAR_1}\nIn: {STR_VAR_2}");
+static const u8 sText_HeapNoLeak[] = _("No leak");
+static const u8 sText_SpriteTileStats[] = _("Free: {STR_VAR_1}\nRuns: {STR_VAR_2}\nLargest: {STR_VAR_3}");
+static const u8 sText_ProfilerSummary[] = _("Profiler: {STR_VAR_1}\nTasks: {STR_VAR_2}\nSprites: {STR_VAR_3}");
+static const u8 sText_ProfilerBudget[] = _("Peak: {STR_VAR_1}\nFrame: {STR_VAR_2}%");
+static const u8 sText_ProfilerFunc[] = _("{STR_VAR_1}. {STR_VAR_2}\nCycles: {STR_VAR_3}");
+static const u8 sText_ProfilerFuncCalls[] = _("Calls: {STR_VAR_1}\nPer call: {STR_VAR_2}");
+static const u8 sText_ProfilerNoFunc[] = _("No function");
 static const u8 sText_On[] = _("{COLOR GREEN}ON");
 static const u8 sText_Off[] = _("{COLOR RED}OFF");
 static const u8 sText_RGBValues[] = _("{COLOR RED}{STR_VAR_1}\n{COLOR GREEN}{STR_VAR_2}\n{COLOR BLUE}{STR_VAR_3}");
@@ -277,6 +304,9 @@ static const struct DebugMenuAction sDebugMenu_MiscActions[] =
     { sText_EnableResetRTC, DebugMenu_EnableResetRTC, NULL },
     { sText_TestBattleTransition, DebugMenu_TestBattleTransition, NULL },
     { sText_FillThePC, DebugMenu_FillThePC, NULL },
+    { sText_HeapStats, DebugMenu_HeapStats, NULL },
+    { sText_SpriteTiles, DebugMenu_SpriteTiles, NULL },
+    { sText_Profiler, DebugMenu_Profiler, NULL },
 };
 
 CREATE_BOUNCER(MiscActions, MainActions);
@@ -369,6 +399,39 @@ static const struct WindowTemplate sDebugMenu_Window_LottoNum =
     .baseBlock = 0x120
 };
 
+static const struct WindowTemplate sDebugMenu_Window_Profiler =
+{
+    .bg = 0,
+    .tilemapLeft = 1,
+    .tilemapTop = 1,
+    .width = 16,
+    .height = 12,
+    .paletteNum = 15,
+    .baseBlock = 0x120
+};
+
+static const struct WindowTemplate sDebugMenu_Window_HeapStats =
+{
+    .bg = 0,
+    .tilemapLeft = 1,
+    .tilemapTop = 1,
+    .width = 14,
+    .height = 12,
+    .paletteNum = 15,
+    .baseBlock = 0x120
+};
+
+static const struct WindowTemplate sDebugMenu_Window_SpriteTiles =
+{
+    .bg = 0,
+    .tilemapLeft = 1,
+    .tilemapTop = 1,
+    .width = 10,
+    .height = 6,
+    .paletteNum = 15,
+    .baseBlock = 0x120
+};
+
 #define tWindowId data[0]
 #define SET_BOUNCER(x) (*((u32 *)(&data[14])) = (u32)(x))
 #define GET_BOUNCER (const struct DebugMenuBouncer *)*((u32 *)(&data[14]))
@@ -1137,6 +1200,310 @@ static void DebugMenu_LottoNumber_ProcessInput(u8 taskId)
 #undef LOTTO_NUM
 #undef SET_LOTTO_NUM
 
+// Page 0 shows the heap totals, and page n the nth most recent entry of the
+// heap log, or of the leak list when showLeaks is set.
+static void DebugMenu_HeapStats_PrintStatus(u8 windowId, u16 page, bool8 showLeaks)
+{
+    struct HeapStats stats;
+    const struct HeapEvent *event;
+    const struct HeapLeak *leak;
+
+    FillWindowPixelBuffer(windowId, 0x11);
+
+    if (page == 0)
+    {
+        GetHeapStats(&stats);
+
+        ConvertUIntToDecimalStringN(gStringVar1, stats.liveBytes, STR_CONV_MODE_LEFT_ALIGN, 6);
+        ConvertUIntToDecimalStringN(gStringVar2, stats.liveBlocks, STR_CONV_MODE_LEFT_ALIGN, 4);
+        ConvertUIntToDecimalStringN(gStringVar3, stats.peakLiveBytes, STR_CONV_MODE_LEFT_ALIGN, 6);
+        StringExpandPlaceholders(gStringVar4, sText_HeapSummary);
+        AddTextPrinterParameterized5(windowId, 2, gStringVar4, 0, 1, 0, NULL, 0, 2);
+
+        ConvertUIntToDecimalStringN(gStringVar1, stats.freeBytes, STR_CONV_MODE_LEFT_ALIGN, 6);
+        ConvertUIntToDecimalStringN(gStringVar2, stats.largestFreeBlock, STR_CONV_MODE_LEFT_ALIGN, 6);
+        ConvertUIntToDecimalStringN(gStringVar3, stats.fragmentation, STR_CONV_MODE_LEFT_ALIGN, 3);
+        StringExpandPlaceholders(gStringVar4, sText_HeapFreeSpace);
+        AddTextPrinterParameterized5(windowId, 2, gStringVar4, 0, 33, 0, NULL, 0, 2);
+    }
+    else if (showLeaks)
+    {
+        leak = GetHeapLeak(page - 1);
+
+        if (leak == NULL)
+        {
+            AddTextPrinterParameterized5(windowId, 2, sText_HeapNoLeak, 0, 1, 0, NULL, 0, 2);
+        }
+        else
+        {
+            ConvertUIntToDecimalStringN(gStringVar1, GetHeapLeakCount() - (page - 1), STR_CONV_MODE_LEFT_ALIGN, 4);
+            ConvertUIntToDecimalStringN(gStringVar2, leak->size, STR_CONV_MODE_LEFT_ALIGN, 6);
+            ConvertIntToHexStringN(gStringVar3, (u32)leak->pointer, STR_CONV_MODE_LEADING_ZEROS, 8);
+            StringExpandPlaceholders(gStringVar4, sText_HeapLeak);
+            AddTextPrinterParameterized5(windowId, 2, gStringVar4, 0, 1, 0, NULL, 0, 2);
+
+            ConvertIntToHexStringN(gStringVar1, (u32)leak->caller, STR_CONV_MODE_LEADING_ZEROS, 8);
+            ConvertIntToHexStringN(gStringVar2, (u32)leak->owner, STR_CONV_MODE_LEADING_ZEROS, 8);
+            StringExpandPlaceholders(gStringVar4, sText_HeapLeakOrigin);
+            AddTextPrinterParameterized5(windowId, 2, gStringVar4, 0, 49, 0, NULL, 0, 2);
+        }
+    }
+    else
+    {
+        event = GetHeapEvent(page - 1);
+
+        if (event == NULL)
+        {
+            AddTextPrinterParameterized5(windowId, 2, sText_HeapNoEvent, 0, 1, 0, NULL, 0, 2);
+        }
+        else
+        {
+            if (event->type == HEAP_EVENT_ALLOC)
+                StringCopy(gStringVar1, sText_HeapAlloc);
+            else if (event->type == HEAP_EVENT_FREE)
+                StringCopy(gStringVar1, sText_HeapFree);
+            else
+                StringCopy(gStringVar1, sText_HeapFail);
+
+            ConvertUIntToDecimalStringN(gStringVar2, event->size, STR_CONV_MODE_LEFT_ALIGN, 6);
+            ConvertIntToHexStringN(gStringVar3, (u32)event->pointer, STR_CONV_MODE_LEADING_ZEROS, 8);
+            StringExpandPlaceholders(gStringVar4, sText_HeapEvent);
+            AddTextPrinterParameterized5(windowId, 2, gStringVar4, 0, 1, 0, NULL, 0, 2);
+
+            ConvertIntToHexStringN(gStringVar1, (u32)event->caller, STR_CONV_MODE_LEADING_ZEROS, 8);
+            StringExpandPlaceholders(gStringVar4, sText_HeapEventCaller);
+            AddTextPrinterParameterized5(windowId, 2, gStringVar4, 0, 49, 0, NULL, 0, 2);
+        }
+    }
+}
+
+#define tPage data[1]
+#define tShowLeaks data[2]
+
+static void DebugMenu_HeapStats(u8 taskId)
+{
+    s16 *data = gTasks[taskId].data;
+
+    DebugMenu_RemoveMenu(taskId);
+    tWindowId = AddWindow(&sDebugMenu_Window_HeapStats);
+    SetStandardWindowBorderStyle(tWindowId, FALSE);
+    tPage = 0;
+    tShowLeaks = FALSE;
+    DebugMenu_HeapStats_PrintStatus(tWindowId, tPage, tShowLeaks);
+    ScheduleBgCopyTilemapToVram(0);
+    gTasks[taskId].func = DebugMenu_HeapStats_ProcessInput;
+}
+
+// A switches the pages after the totals between the heap log and the leak list.
+static void DebugMenu_HeapStats_ProcessInput(u8 taskId)
+{
+    s16 *data = gTasks[taskId].data;
+    u16 lastPage = tShowLeaks ? HEAP_LEAK_LIST_LENGTH : HEAP_LOG_LENGTH;
+
+    if (JOY_REPEAT(DPAD_UP) && tPage != 0)
+    {
+        PlaySE(SE_SELECT);
+        tPage--;
+        DebugMenu_HeapStats_PrintStatus(tWindowId, tPage, tShowLeaks);
+    }
+
+    if (JOY_REPEAT(DPAD_DOWN) && tPage < lastPage)
+    {
+        PlaySE(SE_SELECT);
+        tPage++;
+        DebugMenu_HeapStats_PrintStatus(tWindowId, tPage, tShowLeaks);
+    }
+
+    if (JOY_NEW(A_BUTTON))
+    {
+        PlaySE(SE_SELECT);
+        tShowLeaks = !tShowLeaks;
+        if (tShowLeaks && tPage > HEAP_LEAK_LIST_LENGTH)
+            tPage = HEAP_LEAK_LIST_LENGTH;
+        DebugMenu_HeapStats_PrintStatus(tWindowId, tPage, tShowLeaks);
+    }
+
+    if (JOY_NEW(B_BUTTON))
+    {
+        PlaySE(SE_SELECT);
+        ReturnToPreviousMenu(taskId, GET_BOUNCER);
+    }
+}
+
+#undef tPage
+#undef tShowLeaks
+
+// Shows how much OBJ VRAM is left, and how broken up it is, for sprites that
+// fail to load. A refreshes the numbers.
+static void DebugMenu_SpriteTiles_PrintStatus(u8 windowId)
+{
+    struct SpriteTileStats stats;
+
+    GetSpriteTileStats(&stats);
+    FillWindowPixelBuffer(windowId, 0x11);
+    ConvertUIntToDecimalStringN(gStringVar1, stats.freeTiles, STR_CONV_MODE_LEFT_ALIGN, 4);
+    ConvertUIntToDecimalStringN(gStringVar2, stats.freeRuns, STR_CONV_MODE_LEFT_ALIGN, 4);
+    ConvertUIntToDecimalStringN(gStringVar3, stats.largestFreeRun, STR_CONV_MODE_LEFT_ALIGN, 4);
+    StringExpandPlaceholders(gStringVar4, sText_SpriteTileStats);
+    AddTextPrinterParameterized5(windowId, 2, gStringVar4, 0, 1, 0, NULL, 0, 2);
+}
+
+static void DebugMenu_SpriteTiles(u8 taskId)
+{
+    s16 *data = gTasks[taskId].data;
+
+    DebugMenu_RemoveMenu(taskId);
+    tWindowId = AddWindow(&sDebugMenu_Window_SpriteTiles);
+    SetStandardWindowBorderStyle(tWindowId, FALSE);
+    DebugMenu_SpriteTiles_PrintStatus(tWindowId);
+    ScheduleBgCopyTilemapToVram(0);
+    gTasks[taskId].func = DebugMenu_SpriteTiles_ProcessInput;
+}
+
+static void DebugMenu_SpriteTiles_ProcessInput(u8 taskId)
+{
+    s16 *data = gTasks[taskId].data;
+
+    if (JOY_NEW(A_BUTTON))
+    {
+        PlaySE(SE_SELECT);
+        DebugMenu_SpriteTiles_PrintStatus(tWindowId);
+    }
+
+    if (JOY_NEW(B_BUTTON))
+    {
+        PlaySE(SE_SELECT);
+        ReturnToPreviousMenu(taskId, GET_BOUNCER);
+    }
+}
+
+// Cycles in one frame of the GBA's 16.78 MHz CPU.
+#define CYCLES_PER_FRAME 280896
+#define PROFILER_TOP_COUNT 16
+
+// Page 0 averages the frames in the profiler's ring, leaving out the current
+// one since it's still running. The other pages list the hottest functions.
+static void DebugMenu_Profiler_PrintStatus(u8 windowId, u16 page)
+{
+    struct ProfilerFuncStats funcs[PROFILER_TOP_COUNT];
+    const struct ProfilerFrameStats *frame;
+    u32 taskCycles = 0, spriteCycles = 0, peakCycles = 0;
+    u32 i, numFrames, numFuncs;
+
+    FillWindowPixelBuffer(windowId, 0x11);
+
+    if (page == 0)
+    {
+        for (i = 1, numFrames = 0; (frame = GetProfilerFrame(i)) != NULL; i++, numFrames++)
+        {
+            taskCycles += frame->taskCycles;
+            spriteCycles += frame->spriteCycles;
+            if (frame->taskCycles + frame->spriteCycles > peakCycles)
+                peakCycles = frame->taskCycles + frame->spriteCycles;
+        }
+
+        if (numFrames != 0)
+        {
+            taskCycles /= numFrames;
+            spriteCycles /= numFrames;
+        }
+
+        StringCopy(gStringVar1, gProfilerEnabled ? sText_On : sText_Off);
+        ConvertUIntToDecimalStringN(gStringVar2, taskCycles, STR_CONV_MODE_LEFT_ALIGN, 7);
+        ConvertUIntToDecimalStringN(gStringVar3, spriteCycles, STR_CONV_MODE_LEFT_ALIGN, 7);
+        StringExpandPlaceholders(gStringVar4, sText_ProfilerSummary);
+        AddTextPrinterParameterized5(windowId, 2, gStringVar4, 0, 1, 0, NULL, 0, 2);
+
+        ConvertUIntToDecimalStringN(gStringVar1, peakCycles, STR_CONV_MODE_LEFT_ALIGN, 7);
+        ConvertUIntToDecimalStringN(gStringVar2, ((taskCycles + spriteCycles) * 100) / CYCLES_PER_FRAME, STR_CONV_MODE_LEFT_ALIGN, 3);
+        StringExpandPlaceholders(gStringVar4, sText_ProfilerBudget);
+        AddTextPrinterParameterized5(windowId, 2, gStringVar4, 0, 49, 0, NULL, 0, 2);
+    }
+    else
+    {
+        numFuncs = GetProfilerTopFuncs(funcs, PROFILER_TOP_COUNT);
+
+        if (page > numFuncs)
+        {
+            AddTextPrinterParameterized5(windowId, 2, sText_ProfilerNoFunc, 0, 1, 0, NULL, 0, 2);
+        }
+        else
+        {
+            ConvertUIntToDecimalStringN(gStringVar1, page, STR_CONV_MODE_LEFT_ALIGN, 2);
+            ConvertIntToHexStringN(gStringVar2, (u32)funcs[page - 1].func, STR_CONV_MODE_LEADING_ZEROS, 8);
+            ConvertUIntToDecimalStringN(gStringVar3, funcs[page - 1].cycles, STR_CONV_MODE_LEFT_ALIGN, 10);
+            StringExpandPlaceholders(gStringVar4, sText_ProfilerFunc);
+            AddTextPrinterParameterized5(windowId, 2, gStringVar4, 0, 1, 0, NULL, 0, 2);
+
+            ConvertUIntToDecimalStringN(gStringVar1, funcs[page - 1].calls, STR_CONV_MODE_LEFT_ALIGN, 10);
+            ConvertUIntToDecimalStringN(gStringVar2, funcs[page - 1].cycles / funcs[page - 1].calls, STR_CONV_MODE_LEFT_ALIGN, 7);
+            StringExpandPlaceholders(gStringVar4, sText_ProfilerFuncCalls);
+            AddTextPrinterParameterized5(windowId, 2, gStringVar4, 0, 33, 0, NULL, 0, 2);
+        }
+    }
+
+    CopyWindowToVram(windowId, 2);
+}
+
+#define tPage data[1]
+
+static void DebugMenu_Profiler(u8 taskId)
+{
+    s16 *data = gTasks[taskId].data;
+
+    DebugMenu_RemoveMenu(taskId);
+    tWindowId = AddWindow(&sDebugMenu_Window_Profiler);
+    SetStandardWindowBorderStyle(tWindowId, FALSE);
+    tPage = 0;
+    DebugMenu_Profiler_PrintStatus(tWindowId, tPage);
+    ScheduleBgCopyTilemapToVram(0);
+    gTasks[taskId].func = DebugMenu_Profiler_ProcessInput;
+}
+
+// A turns the profiler on (starting from scratch) or off, SELECT writes the
+// report to the save file.
+static void DebugMenu_Profiler_ProcessInput(u8 taskId)
+{
+    s16 *data = gTasks[taskId].data;
+
+    if (JOY_REPEAT(DPAD_UP) && tPage != 0)
+    {
+        PlaySE(SE_SELECT);
+        tPage--;
+        DebugMenu_Profiler_PrintStatus(tWindowId, tPage);
+    }
+
+    if (JOY_REPEAT(DPAD_DOWN) && tPage != PROFILER_TOP_COUNT)
+    {
+        PlaySE(SE_SELECT);
+        tPage++;
+        DebugMenu_Profiler_PrintStatus(tWindowId, tPage);
+    }
+
+    if (JOY_NEW(A_BUTTON))
+    {
+        PlaySE(SE_SELECT);
+        SetProfilerEnabled(!gProfilerEnabled);
+        DebugMenu_Profiler_PrintStatus(tWindowId, tPage);
+    }
+
+    if (JOY_NEW(SELECT_BUTTON))
+    {
+        if (SaveProfilerReport())
+            PlaySE(SE_SAVE);
+        else
+            PlaySE(SE_FAILURE);
+    }
+
+    if (JOY_NEW(B_BUTTON))
+    {
+        PlaySE(SE_SELECT);
+        ReturnToPreviousMenu(taskId, GET_BOUNCER);
+    }
+}
+
+#undef tPage
+
 static void DebugMenu_ToggleWalkThroughWalls(u8 taskId)
 {
     gWalkThroughWalls = !gWalkThroughWalls;
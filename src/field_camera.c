@@ -1,5 +1,6 @@
 #include "global.h"
 #include "berry.h"
+#include "bg.h"
 #include "bike.h"
 #include "field_camera.h"
 #include "field_player_avatar.h"
@@ -21,7 +22,7 @@ struct FieldCameraOffset
     u8 yPixelOffset;
     u8 xTileOffset;
     u8 yTileOffset;
-    bool8 copyBGToVRAM;
+    u32 dirtyRows; // tilemap rows of BG1-3 that need copying to VRAM
 };
 
 // static functions
@@ -33,6 +34,7 @@ static s32 MapPosToBgTilemapOffset(struct FieldCameraOffset *a, s32 x, s32 y);
 static void DrawWholeMapViewInternal(int x, int y, const struct MapLayout *mapLayout);
 static void DrawMetatileAt(const struct MapLayout *mapLayout, u16, int, int);
 static void DrawMetatile(s32 a, u16 *b, u16 c);
+static void MarkTilemapRowsDirty(struct FieldCameraOffset *cameraOffset, u32 offset);
 static void CameraPanningCB_PanAhead(void);
 
 // IWRAM bss vars
@@ -53,7 +55,7 @@ static void ResetCameraOffset(struct FieldCameraOffset *cameraOffset)
     cameraOffset->yTileOffset = 0;
     cameraOffset->xPixelOffset = 0;
     cameraOffset->yPixelOffset = 0;
-    cameraOffset->copyBGToVRAM = TRUE;
+    cameraOffset->dirtyRows = 0;
 }
 
 static void AddCameraTileOffset(struct FieldCameraOffset *cameraOffset, u32 xOffset, u32 yOffset)
@@ -98,7 +100,9 @@ void sub_8089C08(s16 *x, s16 *y)
 void DrawWholeMapView(void)
 {
     DrawWholeMapViewInternal(gSaveBlock1Ptr->pos.x, gSaveBlock1Ptr->pos.y, gMapHeader.mapLayout);
-    sFieldCameraOffset.copyBGToVRAM = TRUE;
+    ScheduleBgCopyTilemapToVram(1);
+    ScheduleBgCopyTilemapToVram(2);
+    ScheduleBgCopyTilemapToVram(3);
 }
 
 static void DrawWholeMapViewInternal(int x, int y, const struct MapLayout *mapLayout)
@@ -136,7 +140,6 @@ static void RedrawMapSlicesForCameraUpdate(struct FieldCameraOffset *cameraOffse
         RedrawMapSliceNorth(cameraOffset, mapLayout);
     if (y < 0)
         RedrawMapSliceSouth(cameraOffset, mapLayout);
-    cameraOffset->copyBGToVRAM = TRUE;
 }
 
 static void RedrawMapSliceNorth(struct FieldCameraOffset *cameraOffset, const struct MapLayout *mapLayout)
@@ -156,6 +159,7 @@ static void RedrawMapSliceNorth(struct FieldCameraOffset *cameraOffset, const st
             temp -= 32;
         DrawMetatileAt(mapLayout, r7 + temp, gSaveBlock1Ptr->pos.x + i / 2, gSaveBlock1Ptr->pos.y + 14);
     }
+    MarkTilemapRowsDirty(cameraOffset, r7);
 }
 
 static void RedrawMapSliceSouth(struct FieldCameraOffset *cameraOffset, const struct MapLayout *mapLayout)
@@ -171,6 +175,7 @@ static void RedrawMapSliceSouth(struct FieldCameraOffset *cameraOffset, const st
             temp -= 32;
         DrawMetatileAt(mapLayout, r7 + temp, gSaveBlock1Ptr->pos.x + i / 2, gSaveBlock1Ptr->pos.y);
     }
+    MarkTilemapRowsDirty(cameraOffset, r7);
 }
 
 static void RedrawMapSliceEast(struct FieldCameraOffset *cameraOffset, const struct MapLayout *mapLayout)
@@ -186,6 +191,7 @@ static void RedrawMapSliceEast(struct FieldCameraOffset *cameraOffset, const str
             temp -= 32;
         DrawMetatileAt(mapLayout, temp * 32 + r6, gSaveBlock1Ptr->pos.x, gSaveBlock1Ptr->pos.y + i / 2);
     }
+    cameraOffset->dirtyRows = 0xFFFFFFFF;
 }
 
 static void RedrawMapSliceWest(struct FieldCameraOffset *cameraOffset, const struct MapLayout *mapLayout)
@@ -203,6 +209,7 @@ static void RedrawMapSliceWest(struct FieldCameraOffset *cameraOffset, const str
             temp -= 32;
         DrawMetatileAt(mapLayout, temp * 32 + r5, gSaveBlock1Ptr->pos.x + 14, gSaveBlock1Ptr->pos.y + i / 2);
     }
+    cameraOffset->dirtyRows = 0xFFFFFFFF;
 }
 
 void CurrentMapDrawMetatileAt(int x, int y)
@@ -212,7 +219,7 @@ void CurrentMapDrawMetatileAt(int x, int y)
     if (offset >= 0)
     {
         DrawMetatileAt(gMapHeader.mapLayout, offset, x, y);
-        sFieldCameraOffset.copyBGToVRAM = TRUE;
+        MarkTilemapRowsDirty(&sFieldCameraOffset, offset);
     }
 }
 
@@ -223,7 +230,7 @@ void DrawDoorMetatileAt(int x, int y, u16 *arr)
     if (offset >= 0)
     {
         DrawMetatile(1, arr, offset);
-        sFieldCameraOffset.copyBGToVRAM = TRUE;
+        MarkTilemapRowsDirty(&sFieldCameraOffset, offset);
     }
 }
 
@@ -306,9 +313,35 @@ static void DrawMetatile(s32 metatileLayerType, u16 *metatiles, u16 offset)
         gBGTilemapBuffers2[offset + 0x21] = metatiles[7];
         break;
     }
-    ScheduleBgCopyTilemapToVram(1);
-    ScheduleBgCopyTilemapToVram(2);
-    ScheduleBgCopyTilemapToVram(3);
+}
+
+// Metatiles always start on an even row, so both of their rows are on screen.
+static void MarkTilemapRowsDirty(struct FieldCameraOffset *cameraOffset, u32 offset)
+{
+    cameraOffset->dirtyRows |= (u32)3 << (offset / 32);
+}
+
+// Copies the rows redrawn since the last frame instead of whole tilemaps, so a
+// camera step north or south moves 384 bytes of tilemap instead of 6 KiB.
+void FieldCopyDirtyTilemapRowsToVram(void)
+{
+    u32 dirtyRows = sFieldCameraOffset.dirtyRows;
+    u32 row, numRows;
+
+    sFieldCameraOffset.dirtyRows = 0;
+    for (row = 0; row < 32; row++)
+    {
+        if (!((dirtyRows >> row) & 1))
+            continue;
+
+        for (numRows = 1; row + numRows < 32 && ((dirtyRows >> (row + numRows)) & 1); numRows++)
+            ;
+
+        CopyBgTilemapBufferRowsToVram(1, row, numRows);
+        CopyBgTilemapBufferRowsToVram(2, row, numRows);
+        CopyBgTilemapBufferRowsToVram(3, row, numRows);
+        row += numRows; // the row after a run is clean
+    }
 }
 
 static s32 MapPosToBgTilemapOffset(struct FieldCameraOffset *cameraOffset, s32 x, s32 y)
@@ -235,5 +235,6 @@ void sub_81DB620(int windowId, int columnStart, int rowStart, int numFillTiles,
             windowTileData += windowRowSize;
             rowsToFill--;
         }
+        MarkWindowTilesDirty(windowId, rowStart * window->window.width + columnStart, (numRows - 1) * window->window.width + numFillTiles);
     }
 }
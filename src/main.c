@@ -204,6 +204,9 @@ static void CallCallbacks(void)
 
 void SetMainCallback2(MainCallback callback)
 {
+#if DEBUG
+    CheckHeapLeaks(callback);
+#endif
     gMain.callback2 = callback;
     gMain.state = 0;
 }
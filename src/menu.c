@@ -55,6 +55,7 @@ static EWRAM_DATA u8 sYesNoWindowId = 0;
 static EWRAM_DATA u8 sWindowId = 0;
 static EWRAM_DATA u16 sFiller = 0;  // needed to align
 static EWRAM_DATA bool8 sScheduledBgCopiesToVram[4] = {FALSE};
+static EWRAM_DATA bool8 sScheduledBgDirtyRowCopiesToVram[4] = {FALSE};
 static EWRAM_DATA u16 sTempTileDataBufferIdx = 0;
 static EWRAM_DATA void *sTempTileDataBuffer[0x20] = {NULL};
 
@@ -1937,6 +1938,7 @@ u8 sub_8199944(u8 windowId, u8 optionWidth, u8 columns, u8 rows, u8 initialCurso
 void ClearScheduledBgCopiesToVram(void)
 {
     memset(sScheduledBgCopiesToVram, 0, sizeof(sScheduledBgCopiesToVram));
+    memset(sScheduledBgDirtyRowCopiesToVram, 0, sizeof(sScheduledBgDirtyRowCopiesToVram));
 }
 
 void ScheduleBgCopyTilemapToVram(u8 bgId)
@@ -1944,27 +1946,25 @@ void ScheduleBgCopyTilemapToVram(u8 bgId)
     sScheduledBgCopiesToVram[bgId] = TRUE;
 }
 
+// For BGs whose tilemap buffer is only written through bg.c, or whose other
+// writers mark the rows they change. See CopyBgTilemapBufferDirtyRowsToVram.
+void ScheduleBgCopyTilemapDirtyRowsToVram(u8 bgId)
+{
+    sScheduledBgDirtyRowCopiesToVram[bgId] = TRUE;
+}
+
 void DoScheduledBgTilemapCopiesToVram(void)
 {
-    if (sScheduledBgCopiesToVram[0] == TRUE)
-    {
-        CopyBgTilemapBufferToVram(0);
-        sScheduledBgCopiesToVram[0] = FALSE;
-    }
-    if (sScheduledBgCopiesToVram[1] == TRUE)
-    {
-        CopyBgTilemapBufferToVram(1);
-        sScheduledBgCopiesToVram[1] = FALSE;
-    }
-    if (sScheduledBgCopiesToVram[2] == TRUE)
-    {
-        CopyBgTilemapBufferToVram(2);
-        sScheduledBgCopiesToVram[2] = FALSE;
-    }
-    if (sScheduledBgCopiesToVram[3] == TRUE)
+    u8 i;
+
+    for (i = 0; i < ARRAY_COUNT(sScheduledBgCopiesToVram); i++)
     {
-        CopyBgTilemapBufferToVram(3);
-        sScheduledBgCopiesToVram[3] = FALSE;
+        if (sScheduledBgCopiesToVram[i] == TRUE)
+            CopyBgTilemapBufferToVram(i);
+        else if (sScheduledBgDirtyRowCopiesToVram[i] == TRUE)
+            CopyBgTilemapBufferDirtyRowsToVram(i);
+        sScheduledBgCopiesToVram[i] = FALSE;
+        sScheduledBgDirtyRowCopiesToVram[i] = FALSE;
     }
 }
 
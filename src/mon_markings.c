@@ -607,5 +607,5 @@ static struct Sprite *sub_811FFD4(u16 tileTag, u16 paletteTag, const u16 *palett
 
 void sub_8120084(u8 markings, void *dest)
 {
-    RequestDma3Copy(gUnknown_0859E67C + markings * 0x80, dest, 0x80, 0x10);
+    RequestDma3CopyWithPriority(gUnknown_0859E67C + markings * 0x80, dest, 0x80, 0x10, DMA3_PRIORITY_HIGH);
 }
@@ -1580,6 +1580,7 @@ static void OverworldBasic(void)
     BuildOamBuffer();
     UpdatePaletteFade();
     UpdateTilesetAnimations();
+    FieldCopyDirtyTilemapRowsToVram();
     DoScheduledBgTilemapCopiesToVram();
 }
 
@@ -54,6 +54,7 @@ static u8 UpdateHardwarePaletteFade(void);
 static void UpdateBlendRegisters(void);
 static bool8 IsSoftwarePaletteFadeFinishing(void);
 static void Task_BlendPalettesGradually(u8 taskId);
+static void BuildBlendTables(u8 coeff, u16 blendColor);
 
 // palette buffers require alignment with agbcc because
 // unaligned word reads are issued in BlendPalette otherwise
@@ -63,6 +64,8 @@ EWRAM_DATA struct PaletteStruct sPaletteStructs[0x10] = {0};
 EWRAM_DATA struct PaletteFadeControl gPaletteFade = {0};
 static EWRAM_DATA u32 gFiller_2037FE0 = 0;
 static EWRAM_DATA u32 sPlttBufferTransferPending = 0;
+static EWRAM_DATA u16 sBlendTables[3][32] = {0};
+static EWRAM_DATA u32 sBlendTablesKey = 0;
 EWRAM_DATA u8 gPaletteDecompressionBuffer[PLTT_DECOMP_BUFFER_SIZE] = {0};
 
 static const struct PaletteStructTemplate gDummyPaletteStructTemplate = {
@@ -84,6 +87,7 @@ void LoadCompressedPalette(const u32 *src, u16 offset, u16 size)
 {
     LZDecompressWram(src, gPaletteDecompressionBuffer);
     CpuFill16(RGB_BLACK, gPlttBufferPreDN + offset, size);
+    ClearPaletteSlotsTintable(offset, size);
     CpuCopy16(gPaletteDecompressionBuffer, gPlttBufferUnfaded + offset, size);
     CpuCopy16(gPaletteDecompressionBuffer, gPlttBufferFaded + offset, size);
 }
@@ -91,6 +95,7 @@ void LoadCompressedPalette(const u32 *src, u16 offset, u16 size)
 void LoadPalette(const void *src, u16 offset, u16 size)
 {
     CpuFill16(RGB_BLACK, gPlttBufferPreDN + offset, size);
+    ClearPaletteSlotsTintable(offset, size);
     CpuCopy16(src, gPlttBufferUnfaded + offset, size);
     CpuCopy16(src, gPlttBufferFaded + offset, size);
 }
@@ -98,6 +103,7 @@ void LoadPalette(const void *src, u16 offset, u16 size)
 void FillPalette(u16 value, u16 offset, u16 size)
 {
     CpuFill16(RGB_BLACK, gPlttBufferPreDN + offset, size);
+    ClearPaletteSlotsTintable(offset, size);
     CpuFill16(value, gPlttBufferUnfaded + offset, size);
     CpuFill16(value, gPlttBufferFaded + offset, size);
 }
@@ -156,6 +162,7 @@ void ReadPlttIntoBuffers(void)
         gPlttBufferUnfaded[i] = pltt[i];
         gPlttBufferFaded[i] = pltt[i];
     }
+    ClearPaletteSlotsTintable(0, PLTT_SIZE);
 }
 
 bool8 BeginNormalPaletteFade(u32 selectedPalettes, s8 delay, u8 startY, u8 targetY, u16 blendColor)
@@ -413,9 +420,6 @@ static u8 GetPaletteNumByUid(u16 uid)
 
 static u8 UpdateNormalPaletteFade(void)
 {
-    u16 paletteOffset;
-    u16 selectedPalettes;
-
     if (!gPaletteFade.active)
         return PALETTE_FADE_STATUS_DONE;
 
@@ -425,69 +429,41 @@ static u8 UpdateNormalPaletteFade(void)
     }
     else
     {
-        if (!gPaletteFade.objPaletteToggle)
+        if (gPaletteFade.delayCounter < gPaletteFade_delay)
         {
-            if (gPaletteFade.delayCounter < gPaletteFade_delay)
-            {
-                gPaletteFade.delayCounter++;
-                return 2;
-            }
-            gPaletteFade.delayCounter = 0;
+            gPaletteFade.delayCounter++;
+            return 2;
         }
+        gPaletteFade.delayCounter = 0;
 
-        paletteOffset = 0;
+        // BG and OBJ palettes used to be blended on alternate frames. With the
+        // blend tables both halves fit in one frame, so each step takes one.
+        BlendPalettes(gPaletteFade_selectedPalettes, gPaletteFade.y, gPaletteFade.blendColor);
 
-        if (!gPaletteFade.objPaletteToggle)
+        if (gPaletteFade.y == gPaletteFade.targetY)
         {
-            selectedPalettes = gPaletteFade_selectedPalettes;
+            gPaletteFade_selectedPalettes = 0;
+            gPaletteFade.softwareFadeFinishing = 1;
         }
         else
         {
-            selectedPalettes = gPaletteFade_selectedPalettes >> 16;
-            paletteOffset = 256;
-        }
+            s8 val;
 
-        while (selectedPalettes)
-        {
-            if (selectedPalettes & 1)
-                BlendPalette(
-                    paletteOffset,
-                    16,
-                    gPaletteFade.y,
-                    gPaletteFade.blendColor);
-            selectedPalettes >>= 1;
-            paletteOffset += 16;
-        }
-
-        gPaletteFade.objPaletteToggle ^= 1;
-
-        if (!gPaletteFade.objPaletteToggle)
-        {
-            if (gPaletteFade.y == gPaletteFade.targetY)
+            if (!gPaletteFade.yDec)
             {
-                gPaletteFade_selectedPalettes = 0;
-                gPaletteFade.softwareFadeFinishing = 1;
+                val = gPaletteFade.y;
+                val += gPaletteFade.deltaY;
+                if (val > gPaletteFade.targetY)
+                    val = gPaletteFade.targetY;
+                gPaletteFade.y = val;
             }
             else
             {
-                s8 val;
-
-                if (!gPaletteFade.yDec)
-                {
-                    val = gPaletteFade.y;
-                    val += gPaletteFade.deltaY;
-                    if (val > gPaletteFade.targetY)
-                        val = gPaletteFade.targetY;
-                    gPaletteFade.y = val;
-                }
-                else
-                {
-                    val = gPaletteFade.y;
-                    val -= gPaletteFade.deltaY;
-                    if (val < gPaletteFade.targetY)
-                        val = gPaletteFade.targetY;
-                    gPaletteFade.y = val;
-                }
+                val = gPaletteFade.y;
+                val -= gPaletteFade.deltaY;
+                if (val < gPaletteFade.targetY)
+                    val = gPaletteFade.targetY;
+                gPaletteFade.y = val;
             }
         }
 
@@ -835,14 +811,55 @@ static bool8 IsSoftwarePaletteFadeFinishing(void)
     }
 }
 
+// For a given coefficient and blend color every channel only has 32 possible
+// results, so they're worked out once and each color becomes three lookups.
+// The entries are the same expressions BlendPalette uses, already shifted into
+// place, so the output matches it bit for bit.
+static void BuildBlendTables(u8 coeff, u16 blendColor)
+{
+    struct PlttData *target = (struct PlttData *)&blendColor;
+    u32 key = 0x80000000 | (coeff << 16) | blendColor;
+    s32 i;
+
+    if (sBlendTablesKey == key)
+        return;
+
+    for (i = 0; i < 32; i++)
+    {
+        sBlendTables[0][i] = (i + (((target->r - i) * coeff) >> 4)) << 0;
+        sBlendTables[1][i] = (i + (((target->g - i) * coeff) >> 4)) << 5;
+        sBlendTables[2][i] = (i + (((target->b - i) * coeff) >> 4)) << 10;
+    }
+
+    sBlendTablesKey = key;
+}
+
 void BlendPalettes(u32 selectedPalettes, u8 coeff, u16 color)
 {
     u16 paletteOffset;
+    const u16 *src;
+    u16 *dest;
+    s32 i;
+
+    if (selectedPalettes == 0)
+        return;
+
+    BuildBlendTables(coeff, color);
 
     for (paletteOffset = 0; selectedPalettes; paletteOffset += 16)
     {
         if (selectedPalettes & 1)
-            BlendPalette(paletteOffset, 16, coeff, color);
+        {
+            src = &gPlttBufferUnfaded[paletteOffset];
+            dest = &gPlttBufferFaded[paletteOffset];
+            for (i = 0; i < 16; i++)
+            {
+                u32 unfaded = src[i];
+                dest[i] = sBlendTables[0][unfaded & 0x1F]
+                        | sBlendTables[1][(unfaded >> 5) & 0x1F]
+                        | sBlendTables[2][(unfaded >> 10) & 0x1F];
+            }
+        }
         selectedPalettes >>= 1;
     }
 }
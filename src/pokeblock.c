@@ -630,6 +630,7 @@ static bool8 LoadPokeblockMenuGfx(void)
         if (FreeTempTileDataBuffersIfPossible() != TRUE)
         {
             LZDecompressWram(gMenuPokeblock_Tilemap, sPokeblockMenu->tilemap);
+            MarkBgTilemapBufferRowsDirty(2, 0, 32);
             sPokeblockMenu->gfxState++;
         }
         break;
@@ -793,7 +794,7 @@ static void sub_8135FCC(s32 pkblId)
 static void HandlePokeblockMenuCursor(u16 cursorPos, u16 arg1)
 {
     FillBgTilemapBufferRect_Palette0(2, arg1, 0xF, (cursorPos * 2) + 1, 0xE, 2);
-    ScheduleBgCopyTilemapToVram(2);
+    ScheduleBgCopyTilemapDirtyRowsToVram(2);
 }
 
 static void CompactPokeblockSlots(void)
@@ -54,6 +54,12 @@
 #define PHONE_CARD_MAX_SHOWN_CONTACTS 5
 #define PHONE_CARD_MAX_NAME_LENGTH 31
 
+// Everything the Pokégear allocates lives in one arena, released on exit.
+// The slack covers rounding each allocation up to a multiple of 4.
+#define POKEGEAR_ARENA_SIZE (sizeof(struct RegionMap)                                               \
+                           + PHONE_CONTACT_COUNT * (PHONE_CARD_MAX_NAME_LENGTH + sizeof(struct ListMenuItem) + 1) \
+                           + 16)
+
 #define TAG_DIGITS       12345
 #define TAG_ICONS        12346
 #define TAG_PHONE_SIGNAL 12347
@@ -70,6 +76,7 @@ enum CardType {
 
 static EWRAM_DATA struct {
     MainCallback callback;
+    struct Arena arena;
     struct RegionMap *map;
     struct ListMenuItem *phoneContactItems;
     u8 *phoneContactNames;
@@ -585,6 +592,14 @@ void CB2_InitPokegear(void)
 {
     u8 newTask;
 
+    // Without its arena there is nowhere to put the region map or the
+    // contact list, so go back to the start menu instead.
+    if (!ArenaBegin(&sPokegearStruct.arena, POKEGEAR_ARENA_SIZE))
+    {
+        SetMainCallback2(CB2_ReturnToFieldWithOpenMenu);
+        return;
+    }
+
     ResetTasks();
     SetVBlankCallback(NULL);
     SetGpuReg(REG_OFFSET_DISPCNT, 0);
@@ -703,10 +718,11 @@ static void UnloadCard(enum CardType cardId)
 
 static void FreePokegearData(void)
 {
-    FREE_AND_SET_NULL(sPokegearStruct.map);
-    FREE_AND_SET_NULL(sPokegearStruct.phoneContactNames);
-    FREE_AND_SET_NULL(sPokegearStruct.phoneContactItems);
-    FREE_AND_SET_NULL(sPokegearStruct.phoneContactIds);
+    ArenaReset(&sPokegearStruct.arena);
+    sPokegearStruct.map = NULL;
+    sPokegearStruct.phoneContactNames = NULL;
+    sPokegearStruct.phoneContactItems = NULL;
+    sPokegearStruct.phoneContactIds = NULL;
 }
 
 #define tState data[0]
@@ -934,7 +950,11 @@ static void LoadCardBgs(enum CardType newCard)
         case MapCard:
             ShowBg(2);
             LZ77UnCompVram(gMapCardTilemap, (void *)(VRAM + 0xE000));
-            sPokegearStruct.map = AllocZeroed(sizeof(struct RegionMap));
+            // The region map is reused when coming back to the map card.
+            if (sPokegearStruct.map == NULL)
+                sPokegearStruct.map = ArenaAlloc(&sPokegearStruct.arena, sizeof(struct RegionMap));
+            else
+                memset(sPokegearStruct.map, 0, sizeof(struct RegionMap));
             InitRegionMapData(sPokegearStruct.map, &sBgTemplates[2], MAPMODE_POKEGEAR, REGION_MAP_XOFF);  // TODO: Make check for button
             while(LoadRegionMapGfx(FALSE));
             break;
@@ -1915,17 +1935,17 @@ static void InitPhoneCardData(void)
         // we can only ever delete contacts from this menu, so no need to reallocate if the lists already exist
         if (!sPokegearStruct.phoneContactNames)
         {
-            sPokegearStruct.phoneContactNames = Alloc(contactCount * PHONE_CARD_MAX_NAME_LENGTH);
+            sPokegearStruct.phoneContactNames = ArenaAlloc(&sPokegearStruct.arena, contactCount * PHONE_CARD_MAX_NAME_LENGTH);
         }
 
         if (!sPokegearStruct.phoneContactItems)
         {
-            sPokegearStruct.phoneContactItems = Alloc(contactCount * sizeof(struct ListMenuItem));
+            sPokegearStruct.phoneContactItems = ArenaAlloc(&sPokegearStruct.arena, contactCount * sizeof(struct ListMenuItem));
         }
 
         if (!sPokegearStruct.phoneContactIds)
         {
-            sPokegearStruct.phoneContactIds = Alloc(contactCount);
+            sPokegearStruct.phoneContactIds = ArenaAlloc(&sPokegearStruct.arena, contactCount);
         }
 
         for (i = 0; i < contactCount; i++)
@@ -58,6 +58,7 @@ struct SpeciesItem
 
 // this file's functions
 static u16 CalculateBoxMonChecksum(struct BoxPokemon *boxMon);
+static u8 GetLevelFromExp(u16 species, u32 exp);
 static union PokemonSubstruct *GetSubstruct(struct BoxPokemon *boxMon, u32 personality, u8 substructType);
 static void EncryptBoxMon(struct BoxPokemon *boxMon);
 static void DecryptBoxMon(struct BoxPokemon *boxMon);
@@ -2223,6 +2224,7 @@ void CreateMon(struct Pokemon *mon, u16 species, u8 level, u8 fixedIV, u8 person
 
 void CreateBoxMon(struct BoxPokemon *boxMon, u16 species, u8 level, u8 fixedIV, u8 personalityType, u32 fixedPersonality, u8 otIdType, u32 fixedOtId)
 {
+    struct DecodedBoxMon decoded;
     u8 speciesName[POKEMON_NAME_LENGTH + 1];
     u32 personality;
     u32 value;
@@ -2278,53 +2280,46 @@ void CreateBoxMon(struct BoxPokemon *boxMon, u16 species, u8 level, u8 fixedIV,
     SetBoxMonData(boxMon, MON_DATA_NICKNAME, speciesName);
     SetBoxMonData(boxMon, MON_DATA_LANGUAGE, &gGameLanguage);
     SetBoxMonData(boxMon, MON_DATA_OT_NAME, gSaveBlock2Ptr->playerName);
-    SetBoxMonData(boxMon, MON_DATA_SPECIES, &species);
-    SetBoxMonData(boxMon, MON_DATA_EXP, &gExperienceTables[gBaseStats[species].growthRate][level]);
-    SetBoxMonData(boxMon, MON_DATA_FRIENDSHIP, &gBaseStats[species].friendship);
-    value = GetCurrentRegionMapSectionId();
-    SetBoxMonData(boxMon, MON_DATA_MET_LOCATION, &value);
-    SetBoxMonData(boxMon, MON_DATA_MET_LEVEL, &level);
-    SetBoxMonData(boxMon, MON_DATA_MET_GAME, &gGameVersion);
-    value = ITEM_POKE_BALL;
-    SetBoxMonData(boxMon, MON_DATA_POKEBALL, &value);
-    SetBoxMonData(boxMon, MON_DATA_OT_GENDER, &gSaveBlock2Ptr->playerGender);
+
+    DecodeBoxMon(boxMon, &decoded);
+    decoded.substruct0.species = species;
+    boxMon->hasSpecies = (species != SPECIES_NONE);
+    decoded.substruct0.experience = gExperienceTables[gBaseStats[species].growthRate][level];
+    decoded.substruct0.friendship = gBaseStats[species].friendship;
+    decoded.substruct3.metLocation = GetCurrentRegionMapSectionId();
+    decoded.substruct3.metLevel = level;
+    decoded.substruct3.metGame = gGameVersion;
+    decoded.substruct3.pokeball = ITEM_POKE_BALL;
+    decoded.substruct3.otGender = gSaveBlock2Ptr->playerGender;
 
     if (fixedIV < 32)
     {
-        SetBoxMonData(boxMon, MON_DATA_HP_IV, &fixedIV);
-        SetBoxMonData(boxMon, MON_DATA_ATK_IV, &fixedIV);
-        SetBoxMonData(boxMon, MON_DATA_DEF_IV, &fixedIV);
-        SetBoxMonData(boxMon, MON_DATA_SPEED_IV, &fixedIV);
-        SetBoxMonData(boxMon, MON_DATA_SPATK_IV, &fixedIV);
-        SetBoxMonData(boxMon, MON_DATA_SPDEF_IV, &fixedIV);
+        decoded.substruct3.hpIV = fixedIV;
+        decoded.substruct3.attackIV = fixedIV;
+        decoded.substruct3.defenseIV = fixedIV;
+        decoded.substruct3.speedIV = fixedIV;
+        decoded.substruct3.spAttackIV = fixedIV;
+        decoded.substruct3.spDefenseIV = fixedIV;
     }
     else
     {
-        u32 iv;
         value = Random();
 
-        iv = value & 0x1F;
-        SetBoxMonData(boxMon, MON_DATA_HP_IV, &iv);
-        iv = (value & 0x3E0) >> 5;
-        SetBoxMonData(boxMon, MON_DATA_ATK_IV, &iv);
-        iv = (value & 0x7C00) >> 10;
-        SetBoxMonData(boxMon, MON_DATA_DEF_IV, &iv);
+        decoded.substruct3.hpIV = value & 0x1F;
+        decoded.substruct3.attackIV = (value & 0x3E0) >> 5;
+        decoded.substruct3.defenseIV = (value & 0x7C00) >> 10;
 
         value = Random();
 
-        iv = value & 0x1F;
-        SetBoxMonData(boxMon, MON_DATA_SPEED_IV, &iv);
-        iv = (value & 0x3E0) >> 5;
-        SetBoxMonData(boxMon, MON_DATA_SPATK_IV, &iv);
-        iv = (value & 0x7C00) >> 10;
-        SetBoxMonData(boxMon, MON_DATA_SPDEF_IV, &iv);
+        decoded.substruct3.speedIV = value & 0x1F;
+        decoded.substruct3.spAttackIV = (value & 0x3E0) >> 5;
+        decoded.substruct3.spDefenseIV = (value & 0x7C00) >> 10;
     }
 
     if (gBaseStats[species].abilities[1])
-    {
-        value = personality & 1;
-        SetBoxMonData(boxMon, MON_DATA_ABILITY_NUM, &value);
-    }
+        decoded.substruct3.abilityNum = personality & 1;
+
+    EncodeBoxMon(boxMon, &decoded);
 
     GiveBoxMonInitialMoveset(boxMon);
 }
@@ -2833,24 +2828,35 @@ static u16 CalculateBoxMonChecksum(struct BoxPokemon *boxMon)
 
 void CalculateMonStats(struct Pokemon *mon)
 {
+    struct DecodedBoxMon decoded;
     s32 oldMaxHP = GetMonData(mon, MON_DATA_MAX_HP, NULL);
     s32 currentHP = GetMonData(mon, MON_DATA_HP, NULL);
-    s32 hpIV = GetMonData(mon, MON_DATA_HP_IV, NULL);
-    s32 hpEV = GetMonData(mon, MON_DATA_HP_EV, NULL);
-    s32 attackIV = GetMonData(mon, MON_DATA_ATK_IV, NULL);
-    s32 attackEV = GetMonData(mon, MON_DATA_ATK_EV, NULL);
-    s32 defenseIV = GetMonData(mon, MON_DATA_DEF_IV, NULL);
-    s32 defenseEV = GetMonData(mon, MON_DATA_DEF_EV, NULL);
-    s32 speedIV = GetMonData(mon, MON_DATA_SPEED_IV, NULL);
-    s32 speedEV = GetMonData(mon, MON_DATA_SPEED_EV, NULL);
-    s32 spAttackIV = GetMonData(mon, MON_DATA_SPATK_IV, NULL);
-    s32 spAttackEV = GetMonData(mon, MON_DATA_SPATK_EV, NULL);
-    s32 spDefenseIV = GetMonData(mon, MON_DATA_SPDEF_IV, NULL);
-    s32 spDefenseEV = GetMonData(mon, MON_DATA_SPDEF_EV, NULL);
-    u16 species = GetMonData(mon, MON_DATA_SPECIES, NULL);
-    s32 level = GetLevelFromMonExp(mon);
+    s32 hpIV, hpEV;
+    s32 attackIV, attackEV;
+    s32 defenseIV, defenseEV;
+    s32 speedIV, speedEV;
+    s32 spAttackIV, spAttackEV;
+    s32 spDefenseIV, spDefenseEV;
+    u16 species;
+    s32 level;
     s32 newMaxHP;
 
+    DecodeBoxMon(&mon->box, &decoded);
+    hpIV = decoded.substruct3.hpIV;
+    hpEV = decoded.substruct2.hpEV;
+    attackIV = decoded.substruct3.attackIV;
+    attackEV = decoded.substruct2.attackEV;
+    defenseIV = decoded.substruct3.defenseIV;
+    defenseEV = decoded.substruct2.defenseEV;
+    speedIV = decoded.substruct3.speedIV;
+    speedEV = decoded.substruct2.speedEV;
+    spAttackIV = decoded.substruct3.spAttackIV;
+    spAttackEV = decoded.substruct2.spAttackEV;
+    spDefenseIV = decoded.substruct3.spDefenseIV;
+    spDefenseEV = decoded.substruct2.spDefenseEV;
+    species = mon->box.isBadEgg ? SPECIES_EGG : decoded.substruct0.species;
+    level = GetLevelFromExp(species, decoded.substruct0.experience);
+
     SetMonData(mon, MON_DATA_LEVEL, &level);
 
     if (species == SPECIES_SHEDINJA)
@@ -2907,10 +2913,8 @@ void BoxMonToMon(const struct BoxPokemon *src, struct Pokemon *dest)
     CalculateMonStats(dest);
 }
 
-u8 GetLevelFromMonExp(struct Pokemon *mon)
+static u8 GetLevelFromExp(u16 species, u32 exp)
 {
-    u16 species = GetMonData(mon, MON_DATA_SPECIES, NULL);
-    u32 exp = GetMonData(mon, MON_DATA_EXP, NULL);
     s32 level = 1;
 
     while (level <= MAX_LEVEL && gExperienceTables[gBaseStats[species].growthRate][level] <= exp)
@@ -2919,16 +2923,17 @@ u8 GetLevelFromMonExp(struct Pokemon *mon)
     return level - 1;
 }
 
-u8 GetLevelFromBoxMonExp(struct BoxPokemon *boxMon)
+u8 GetLevelFromMonExp(struct Pokemon *mon)
 {
-    u16 species = GetBoxMonData(boxMon, MON_DATA_SPECIES, NULL);
-    u32 exp = GetBoxMonData(boxMon, MON_DATA_EXP, NULL);
-    s32 level = 1;
+    return GetLevelFromBoxMonExp(&mon->box);
+}
 
-    while (level <= MAX_LEVEL && gExperienceTables[gBaseStats[species].growthRate][level] <= exp)
-        level++;
+u8 GetLevelFromBoxMonExp(struct BoxPokemon *boxMon)
+{
+    struct DecodedBoxMon decoded;
 
-    return level - 1;
+    DecodeBoxMon(boxMon, &decoded);
+    return GetLevelFromExp(boxMon->isBadEgg ? SPECIES_EGG : decoded.substruct0.species, decoded.substruct0.experience);
 }
 
 u16 GiveMoveToMon(struct Pokemon *mon, u16 move)
@@ -3617,6 +3622,86 @@ static union PokemonSubstruct *GetSubstruct(struct BoxPokemon *boxMon, u32 perso
     return substruct;
 }
 
+#define SUBSTRUCT_WORDS (sizeof(union PokemonSubstruct) / sizeof(u32))
+
+static u32 GetSubstructWordOffset(struct BoxPokemon *boxMon, u8 substructType)
+{
+    return (GetSubstruct(boxMon, boxMon->personality, substructType) - boxMon->secure.substructs) * SUBSTRUCT_WORDS;
+}
+
+// Decrypts the secure substructs into words, in canonical order, without touching
+// boxMon. If the checksum doesn't match, boxMon is marked as a Bad Egg the same
+// way GetBoxMonData does it, and FALSE is returned.
+static bool8 DecryptSubstructs(struct BoxPokemon *boxMon, u32 *words)
+{
+    u32 key = boxMon->otId ^ boxMon->personality;
+    u32 offsets[4];
+    u16 checksum = 0;
+    u32 i, j;
+
+    for (i = 0; i < 4; i++)
+    {
+        offsets[i] = GetSubstructWordOffset(boxMon, i);
+        for (j = 0; j < SUBSTRUCT_WORDS; j++)
+        {
+            u32 word = boxMon->secure.raw[offsets[i] + j] ^ key;
+            words[i * SUBSTRUCT_WORDS + j] = word;
+            checksum += word + (word >> 16);
+        }
+    }
+
+    if (checksum != boxMon->checksum)
+    {
+        struct PokemonSubstruct3 substruct3;
+
+        boxMon->isBadEgg = 1;
+        boxMon->isEgg = 1;
+        memcpy(&substruct3, &words[3 * SUBSTRUCT_WORDS], sizeof(substruct3));
+        substruct3.isEgg = 1;
+        memcpy(&words[3 * SUBSTRUCT_WORDS], &substruct3, sizeof(substruct3));
+        for (j = 0; j < SUBSTRUCT_WORDS; j++)
+            boxMon->secure.raw[offsets[3] + j] = words[3 * SUBSTRUCT_WORDS + j] ^ key;
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+bool8 DecodeBoxMon(struct BoxPokemon *boxMon, struct DecodedBoxMon *decoded)
+{
+    u32 words[4 * SUBSTRUCT_WORDS];
+    bool8 isValid = DecryptSubstructs(boxMon, words);
+
+    memcpy(decoded, words, sizeof(*decoded));
+    return isValid;
+}
+
+// Like SetBoxMonData, nothing is written over a mon that fails its checksum.
+void EncodeBoxMon(struct BoxPokemon *boxMon, const struct DecodedBoxMon *decoded)
+{
+    u32 words[4 * SUBSTRUCT_WORDS];
+    u32 key = boxMon->otId ^ boxMon->personality;
+    u16 checksum = 0;
+    u32 i, j;
+
+    if (!DecryptSubstructs(boxMon, words))
+        return;
+
+    memcpy(words, decoded, sizeof(*decoded));
+    for (i = 0; i < 4; i++)
+    {
+        u32 offset = GetSubstructWordOffset(boxMon, i);
+        for (j = 0; j < SUBSTRUCT_WORDS; j++)
+        {
+            u32 word = words[i * SUBSTRUCT_WORDS + j];
+            checksum += word + (word >> 16);
+            boxMon->secure.raw[offset + j] = word ^ key;
+        }
+    }
+
+    boxMon->checksum = checksum;
+}
+
 u32 GetMonData(struct Pokemon *mon, s32 field, u8* data)
 {
     u32 ret;
@@ -1367,32 +1367,37 @@ static bool8 ExtractMonDataToSummaryStruct(struct Pokemon *mon)
 {
     u32 i;
     struct PokeSummary *sum = &sMonSummaryScreen->summary;
+    struct DecodedBoxMon decoded;
     // Spread the data extraction over multiple frames.
     switch (sMonSummaryScreen->switchCounter)
     {
     case 0:
-        sum->species = GetMonData(mon, MON_DATA_SPECIES);
-        sum->species2 = GetMonData(mon, MON_DATA_SPECIES2);
-        sum->exp = GetMonData(mon, MON_DATA_EXP);
+        DecodeBoxMon(&mon->box, &decoded);
+        sum->sanity = mon->box.isBadEgg;
+        sum->species = sum->sanity ? SPECIES_EGG : decoded.substruct0.species;
+        sum->species2 = decoded.substruct0.species;
+        if (sum->species2 != SPECIES_NONE && (decoded.substruct3.isEgg || sum->sanity))
+            sum->species2 = SPECIES_EGG;
+        sum->exp = decoded.substruct0.experience;
         sum->level = GetMonData(mon, MON_DATA_LEVEL);
-        sum->abilityNum = GetMonData(mon, MON_DATA_ABILITY_NUM);
-        sum->item = GetMonData(mon, MON_DATA_HELD_ITEM);
+        sum->abilityNum = decoded.substruct3.abilityNum;
+        sum->item = decoded.substruct0.heldItem;
         sum->pid = GetMonData(mon, MON_DATA_PERSONALITY);
-        sum->sanity = GetMonData(mon, MON_DATA_SANITY_IS_BAD_EGG);
 
         if (sum->sanity)
             sum->isEgg = TRUE;
         else
-            sum->isEgg = GetMonData(mon, MON_DATA_IS_EGG);
+            sum->isEgg = decoded.substruct3.isEgg;
 
         break;
     case 1:
+        DecodeBoxMon(&mon->box, &decoded);
         for (i = 0; i < MAX_MON_MOVES; i++)
         {
-            sum->moves[i] = GetMonData(mon, MON_DATA_MOVE1+i);
-            sum->pp[i] = GetMonData(mon, MON_DATA_PP1+i);
+            sum->moves[i] = decoded.substruct1.moves[i];
+            sum->pp[i] = decoded.substruct1.pp[i];
         }
-        sum->ppBonuses = GetMonData(mon, MON_DATA_PP_BONUSES);
+        sum->ppBonuses = decoded.substruct0.ppBonuses;
         break;
     case 2:
         if (sMonSummaryScreen->monList.mons == gPlayerParty || sMonSummaryScreen->mode == PSS_MODE_BOX || sMonSummaryScreen->unk40EF == TRUE)
@@ -1422,12 +1427,13 @@ static bool8 ExtractMonDataToSummaryStruct(struct Pokemon *mon)
         GetMonData(mon, MON_DATA_OT_NAME, sum->OTName);
         ConvertInternationalString(sum->OTName, GetMonData(mon, MON_DATA_LANGUAGE));
         sum->ailment = GetMonAilment(mon);
-        sum->OTGender = GetMonData(mon, MON_DATA_OT_GENDER);
+        DecodeBoxMon(&mon->box, &decoded);
+        sum->OTGender = decoded.substruct3.otGender;
         sum->OTID = GetMonData(mon, MON_DATA_OT_ID);
-        sum->metLocation = GetMonData(mon, MON_DATA_MET_LOCATION);
-        sum->metLevel = GetMonData(mon, MON_DATA_MET_LEVEL);
-        sum->metGame = GetMonData(mon, MON_DATA_MET_GAME);
-        sum->friendship = GetMonData(mon, MON_DATA_FRIENDSHIP);
+        sum->metLocation = decoded.substruct3.metLocation;
+        sum->metLevel = decoded.substruct3.metLevel;
+        sum->metGame = decoded.substruct3.metGame;
+        sum->friendship = decoded.substruct0.friendship;
         break;
     default:
         sum->ribbonCount = GetMonData(mon, MON_DATA_RIBBON_COUNT);
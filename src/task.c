@@ -1,10 +1,34 @@
 #include "global.h"
 #include "task.h"
+#include "util.h"
+#if DEBUG
+#include "ereader_helpers.h"
+#include "malloc.h"
+#include "save.h"
+#endif
 
 struct Task gTasks[NUM_TASKS];
 
+// Bit n is set while gTasks[n] is in use. The head and tail of the run list are
+// kept up to date by InsertTask and DestroyTask, and only mean something while
+// a task is active.
+static EWRAM_DATA u16 sActiveTaskSlots = 0;
+static EWRAM_DATA u8 sTaskHead = 0;
+static EWRAM_DATA u8 sTaskTail = 0;
+
+#if DEBUG
+EWRAM_DATA bool8 gProfilerEnabled = FALSE;
+EWRAM_DATA static struct ProfilerFuncStats sProfilerFuncs[PROFILER_NUM_FUNCS] = {0};
+EWRAM_DATA static struct ProfilerFrameStats sProfilerFrames[PROFILER_NUM_FRAMES] = {0};
+EWRAM_DATA static u32 sProfilerFrameCount = 0;
+EWRAM_DATA static u16 sSavedTimer1Count = 0;
+EWRAM_DATA static u16 sSavedTimer1Control = 0;
+
+static void RunTasksProfiled(void);
+#endif
+
 static void InsertTask(u8 newTaskId);
-static u8 FindFirstActiveTask(void);
+static u8 FindFirstFreeTaskSlot(void);
 
 void ResetTasks(void)
 {
@@ -22,23 +46,23 @@ void ResetTasks(void)
 
     gTasks[0].prev = HEAD_SENTINEL;
     gTasks[NUM_TASKS - 1].next = TAIL_SENTINEL;
+
+    sActiveTaskSlots = 0;
 }
 
 u8 CreateTask(TaskFunc func, u8 priority)
 {
-    u8 i;
+    u8 i = FindFirstFreeTaskSlot();
 
-    for (i = 0; i < NUM_TASKS; i++)
+    if (i != NUM_TASKS)
     {
-        if (!gTasks[i].isActive)
-        {
-            gTasks[i].func = func;
-            gTasks[i].priority = priority;
-            InsertTask(i);
-            memset(gTasks[i].data, 0, sizeof(gTasks[i].data));
-            gTasks[i].isActive = TRUE;
-            return i;
-        }
+        gTasks[i].func = func;
+        gTasks[i].priority = priority;
+        InsertTask(i);
+        memset(gTasks[i].data, 0, sizeof(gTasks[i].data));
+        gTasks[i].isActive = TRUE;
+        sActiveTaskSlots |= 1 << i;
+        return i;
     }
 
     return 0;
@@ -46,39 +70,41 @@ u8 CreateTask(TaskFunc func, u8 priority)
 
 static void InsertTask(u8 newTaskId)
 {
-    u8 taskId = FindFirstActiveTask();
+    u8 taskId = sTaskHead;
 
-    if (taskId == NUM_TASKS)
+    if (sActiveTaskSlots == 0)
     {
         // The new task is the only task.
         gTasks[newTaskId].prev = HEAD_SENTINEL;
         gTasks[newTaskId].next = TAIL_SENTINEL;
+        sTaskHead = newTaskId;
+        sTaskTail = newTaskId;
         return;
     }
 
-    while (1)
+    if (gTasks[newTaskId].priority >= gTasks[sTaskTail].priority)
     {
-        if (gTasks[newTaskId].priority < gTasks[taskId].priority)
-        {
-            // We've found a task with a higher priority value,
-            // so we insert the new task before it.
-            gTasks[newTaskId].prev = gTasks[taskId].prev;
-            gTasks[newTaskId].next = taskId;
-            if (gTasks[taskId].prev != HEAD_SENTINEL)
-                gTasks[gTasks[taskId].prev].next = newTaskId;
-            gTasks[taskId].prev = newTaskId;
-            return;
-        }
-        if (gTasks[taskId].next == TAIL_SENTINEL)
-        {
-            // We've reached the end.
-            gTasks[newTaskId].prev = taskId;
-            gTasks[newTaskId].next = gTasks[taskId].next;
-            gTasks[taskId].next = newTaskId;
-            return;
-        }
-        taskId = gTasks[taskId].next;
+        // Tasks of equal priority run in the order they were created, so
+        // most new tasks go at the end.
+        gTasks[newTaskId].prev = sTaskTail;
+        gTasks[newTaskId].next = TAIL_SENTINEL;
+        gTasks[sTaskTail].next = newTaskId;
+        sTaskTail = newTaskId;
+        return;
     }
+
+    // Some task has a higher priority value, so the new task goes before
+    // the first one of those.
+    while (gTasks[newTaskId].priority >= gTasks[taskId].priority)
+        taskId = gTasks[taskId].next;
+
+    gTasks[newTaskId].prev = gTasks[taskId].prev;
+    gTasks[newTaskId].next = taskId;
+    if (gTasks[taskId].prev != HEAD_SENTINEL)
+        gTasks[gTasks[taskId].prev].next = newTaskId;
+    else
+        sTaskHead = newTaskId;
+    gTasks[taskId].prev = newTaskId;
 }
 
 void DestroyTask(u8 taskId)
@@ -86,17 +112,22 @@ void DestroyTask(u8 taskId)
     if (gTasks[taskId].isActive)
     {
         gTasks[taskId].isActive = FALSE;
+        sActiveTaskSlots &= ~(1 << taskId);
 
         if (gTasks[taskId].prev == HEAD_SENTINEL)
         {
             if (gTasks[taskId].next != TAIL_SENTINEL)
+            {
                 gTasks[gTasks[taskId].next].prev = HEAD_SENTINEL;
+                sTaskHead = gTasks[taskId].next;
+            }
         }
         else
         {
             if (gTasks[taskId].next == TAIL_SENTINEL)
             {
                 gTasks[gTasks[taskId].prev].next = TAIL_SENTINEL;
+                sTaskTail = gTasks[taskId].prev;
             }
             else
             {
@@ -109,9 +140,17 @@ void DestroyTask(u8 taskId)
 
 void RunTasks(void)
 {
-    u8 taskId = FindFirstActiveTask();
+    u8 taskId = sTaskHead;
+
+#if DEBUG
+    if (gProfilerEnabled)
+    {
+        RunTasksProfiled();
+        return;
+    }
+#endif
 
-    if (taskId != NUM_TASKS)
+    if (sActiveTaskSlots != 0)
     {
         do
         {
@@ -121,15 +160,14 @@ void RunTasks(void)
     }
 }
 
-static u8 FindFirstActiveTask(void)
+static u8 FindFirstFreeTaskSlot(void)
 {
-    u8 taskId;
+    u32 freeSlots = ~sActiveTaskSlots & ((1 << NUM_TASKS) - 1);
 
-    for (taskId = 0; taskId < NUM_TASKS; taskId++)
-        if (gTasks[taskId].isActive == TRUE && gTasks[taskId].prev == HEAD_SENTINEL)
-            break;
+    if (freeSlots == 0)
+        return NUM_TASKS;
 
-    return taskId;
+    return CountTrailingZeroBits(freeSlots);
 }
 
 void TaskDummy(u8 taskId)
@@ -214,3 +252,205 @@ u32 GetWordTaskArg(u8 taskId, u8 dataElem)
     else
         return 0;
 }
+
+#if DEBUG
+
+// Task and sprite callback profiler. While enabled, timer 1 runs at 1/64 of
+// the CPU clock and every task and sprite callback is timed with it. Single
+// calls are rounded to a tick, but since calls start at random points within
+// a tick, the totals over many calls come out right. A 16-bit count of 64-cycle
+// ticks covers calls of up to 15 frames. Every other timer is taken (sound,
+// flash and link), so timer 1's count and control are saved while the profiler
+// is on and put back when it is turned off.
+
+#define PROFILER_CYCLES_PER_TICK 64
+
+void SetProfilerEnabled(bool8 enabled)
+{
+    if (enabled == gProfilerEnabled)
+        return;
+
+    if (enabled)
+    {
+        sSavedTimer1Count = REG_TM1CNT_L;
+        sSavedTimer1Control = REG_TM1CNT_H;
+        REG_TM1CNT_H = 0;
+        ResetProfiler();
+        REG_TM1CNT_L = 0;
+        REG_TM1CNT_H = TIMER_ENABLE | TIMER_64CLK;
+    }
+    else
+    {
+        // Writing the reload value and then the control register restarts
+        // the timer from the saved count if it was running.
+        REG_TM1CNT_H = 0;
+        REG_TM1CNT_L = sSavedTimer1Count;
+        REG_TM1CNT_H = sSavedTimer1Control;
+    }
+
+    gProfilerEnabled = enabled;
+}
+
+void ResetProfiler(void)
+{
+    memset(sProfilerFuncs, 0, sizeof(sProfilerFuncs));
+    memset(sProfilerFrames, 0, sizeof(sProfilerFrames));
+    sProfilerFrameCount = 0;
+}
+
+u16 ProfilerBegin(void)
+{
+    return REG_TM1CNT_L;
+}
+
+// The last entry is kept out of the hash table. Its func stays NULL, and it
+// collects the calls of every function that didn't fit in the others.
+#define PROFILER_OVERFLOW_FUNC (PROFILER_NUM_FUNCS - 1)
+
+// Open addressing on the function pointer, over every entry but the overflow one.
+static struct ProfilerFuncStats *GetProfilerFuncStats(const void *func)
+{
+    u32 i = ((((u32)func >> 1) * 2654435761u) >> 26) % PROFILER_OVERFLOW_FUNC;
+    u32 probes;
+
+    for (probes = 0; probes < PROFILER_OVERFLOW_FUNC; probes++, i = (i + 1) % PROFILER_OVERFLOW_FUNC)
+    {
+        if (sProfilerFuncs[i].func == func)
+            return &sProfilerFuncs[i];
+        if (sProfilerFuncs[i].func == NULL)
+        {
+            sProfilerFuncs[i].func = func;
+            return &sProfilerFuncs[i];
+        }
+    }
+
+    return &sProfilerFuncs[PROFILER_OVERFLOW_FUNC];
+}
+
+void ProfilerEnd(const void *func, u16 start, bool8 isSprite)
+{
+    u32 cycles = (u16)(REG_TM1CNT_L - start) * PROFILER_CYCLES_PER_TICK;
+    struct ProfilerFuncStats *stats = GetProfilerFuncStats(func);
+    struct ProfilerFrameStats *frame = &sProfilerFrames[sProfilerFrameCount % PROFILER_NUM_FRAMES];
+
+    stats->cycles += cycles;
+    stats->calls++;
+
+    if (isSprite)
+        frame->spriteCycles += cycles;
+    else
+        frame->taskCycles += cycles;
+}
+
+static void RunTasksProfiled(void)
+{
+    u8 taskId = sTaskHead;
+    TaskFunc func;
+    u16 start;
+
+    // RunTasks is called once per frame, so it starts the next frame's entry.
+    sProfilerFrameCount++;
+    sProfilerFrames[sProfilerFrameCount % PROFILER_NUM_FRAMES].taskCycles = 0;
+    sProfilerFrames[sProfilerFrameCount % PROFILER_NUM_FRAMES].spriteCycles = 0;
+
+    if (sActiveTaskSlots != 0)
+    {
+        do
+        {
+            func = gTasks[taskId].func;
+            start = ProfilerBegin();
+            func(taskId);
+            ProfilerEnd((const void *)func, start, FALSE);
+            taskId = gTasks[taskId].next;
+        } while (taskId != TAIL_SENTINEL);
+    }
+}
+
+// Copies the count functions with the most cycles into dest, most first, and
+// returns how many there were.
+u32 GetProfilerTopFuncs(struct ProfilerFuncStats *dest, u32 count)
+{
+    u32 i, j, found = 0;
+
+    for (i = 0; i < PROFILER_NUM_FUNCS; i++)
+    {
+        if (sProfilerFuncs[i].calls == 0)
+            continue;
+
+        for (j = found; j > 0 && dest[j - 1].cycles < sProfilerFuncs[i].cycles; j--)
+        {
+            if (j < count)
+                dest[j] = dest[j - 1];
+        }
+
+        if (j < count)
+        {
+            dest[j] = sProfilerFuncs[i];
+            if (found < count)
+                found++;
+        }
+    }
+
+    return found;
+}
+
+// Returns the totals of the frame `age` frames ago (0 being the current one),
+// or NULL if it has dropped out of the ring or never happened.
+const struct ProfilerFrameStats *GetProfilerFrame(u32 age)
+{
+    if (age >= PROFILER_NUM_FRAMES || age > sProfilerFrameCount)
+        return NULL;
+
+    return &sProfilerFrames[(sProfilerFrameCount - age) % PROFILER_NUM_FRAMES];
+}
+
+// Layout of the report written by SaveProfilerReport.
+struct ProfilerReport
+{
+    u32 magic;
+    u32 frameCount;
+    struct ProfilerFrameStats frames[PROFILER_NUM_FRAMES]; // oldest first
+    struct ProfilerFuncStats funcs[PROFILER_NUM_FUNCS];    // most cycles first
+};
+
+#define PROFILER_REPORT_MAGIC 0x464F5250 // "PROF"
+
+// The cartridge only has flash and every save sector has an owner, so the
+// report goes to the e-Reader Trainer Hill sector. It is only written if that
+// sector doesn't hold a valid Trainer Hill, so a scanned card is never lost.
+// Read it back from the save file at sector 30 (offset 0x1E000), after the
+// 4-byte section header.
+bool8 SaveProfilerReport(void)
+{
+    struct ProfilerReport *report;
+    const struct ProfilerFrameStats *frame;
+    u8 *buffer;
+    u32 i;
+    bool8 saved;
+
+    if (ReadTrainerHillAndValidate())
+        return FALSE;
+
+    // TryWriteSpecialSaveSection copies a whole sector's worth of data.
+    buffer = AllocZeroed(sizeof(struct SaveSection));
+    if (buffer == NULL)
+        return FALSE;
+
+    report = (struct ProfilerReport *)buffer;
+    report->magic = PROFILER_REPORT_MAGIC;
+    report->frameCount = sProfilerFrameCount;
+
+    for (i = 0; i < PROFILER_NUM_FRAMES; i++)
+    {
+        frame = GetProfilerFrame(PROFILER_NUM_FRAMES - 1 - i);
+        if (frame != NULL)
+            report->frames[i] = *frame;
+    }
+
+    GetProfilerTopFuncs(report->funcs, PROFILER_NUM_FUNCS);
+    saved = (TryWriteSpecialSaveSection(SECTOR_ID_TRAINER_HILL, buffer) == SAVE_STATUS_OK);
+    Free(buffer);
+    return saved;
+}
+
+#endif // DEBUG
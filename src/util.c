@@ -218,18 +218,17 @@ void CopySpriteTiles(u8 shape, u8 size, u8 *tiles, u16 *tilemap, u8 *output)
     }
 }
 
+static const u8 sDeBruijnBitPositions[32] = {
+     0,  1, 28,  2, 29, 14, 24,  3, 30, 22, 20, 15, 25, 17,  4,  8,
+    31, 27, 13, 23, 21, 19, 16,  7, 26, 12, 18,  6, 11,  5, 10,  9,
+};
+
+// The ARM7TDMI has no count-leading/trailing-zeros instruction, so isolate the
+// lowest set bit and look its position up by de Bruijn multiplication.
+// Returns 0 for 0.
 int CountTrailingZeroBits(u32 value)
 {
-    u8 i;
-
-    for (i = 0; i < 32; i++)
-    {
-        if ((value & 1) == 0)
-            value >>= 1;
-        else
-            return i;
-    }
-    return 0;
+    return sDeBruijnBitPositions[((value & -value) * 0x077CB531) >> 27];
 }
 
 u16 CalcCRC16(const u8 *data, s32 length)
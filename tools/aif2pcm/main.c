@@ -25,6 +25,15 @@
 #include <stdint.h>
 #include <limits.h>
 
+#ifndef _WIN32
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
 /* extended.c */
 void ieee754_write_extended (double, uint8_t*);
 double ieee754_read_extended (uint8_t*);
@@ -136,29 +145,132 @@ char *new_file_extension(char *filename, char *ext)
 	return new_filename;
 }
 
-void read_aif(struct Bytes *aif, AifData *aif_data)
+// A read-only view of an input file. On POSIX hosts the file is mmapped so that
+// the sample data can be referenced in place instead of being copied around.
+struct MappedFile {
+	unsigned long length;
+	const uint8_t *data;
+	bool mapped;
+};
+
+void map_file(const char *filename, struct MappedFile *file)
+{
+#ifndef _WIN32
+	int fd = open(filename, O_RDONLY);
+	if (fd < 0)
+	{
+		FATAL_ERROR("Failed to open '%s' for reading!\n", filename);
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0)
+	{
+		FATAL_ERROR("Failed to stat '%s'!\n", filename);
+	}
+	file->length = st.st_size;
+	if (file->length == 0)
+	{
+		FATAL_ERROR("Failed to read data from '%s'!\n", filename);
+	}
+	void *data = mmap(NULL, file->length, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED)
+	{
+		FATAL_ERROR("Failed to map '%s'!\n", filename);
+	}
+	file->data = data;
+	file->mapped = true;
+#else
+	struct Bytes *bytes = read_bytearray(filename);
+	file->length = bytes->length;
+	file->data = bytes->data;
+	file->mapped = false;
+	free(bytes);
+#endif
+}
+
+void unmap_file(struct MappedFile *file)
+{
+#ifndef _WIN32
+	if (file->mapped)
+	{
+		munmap((void *)file->data, file->length);
+		return;
+	}
+#endif
+	free((void *)file->data);
+}
+
+// Walks the IFF chunks of a FORM body one at a time without copying them.
+struct ChunkReader {
+	const uint8_t *data;
+	unsigned long length;
+	unsigned long pos;
+};
+
+struct Chunk {
+	char name[5];
+	unsigned long size;
+	unsigned long offset;
+	const uint8_t *data;
+};
+
+static uint16_t read_u16_be(const uint8_t *src)
+{
+	return (src[0] << 8) | src[1];
+}
+
+static uint32_t read_u32_be(const uint8_t *src)
+{
+	return ((uint32_t)src[0] << 24) | (src[1] << 16) | (src[2] << 8) | src[3];
+}
+
+bool next_chunk(struct ChunkReader *reader, struct Chunk *chunk)
+{
+	if ((reader->pos + 8) >= reader->length)
+	{
+		return false;
+	}
+
+	memcpy(chunk->name, &reader->data[reader->pos], 4);
+	chunk->name[4] = '\0';
+	chunk->size = read_u32_be(&reader->data[reader->pos + 4]);
+	reader->pos += 8;
+
+	if ((reader->pos + chunk->size) > reader->length)
+	{
+		FATAL_ERROR("%s chunk at 0x%lx reached end of file before finishing\n", chunk->name, reader->pos);
+	}
+
+	chunk->offset = reader->pos;
+	chunk->data = &reader->data[reader->pos];
+	reader->pos += chunk->size;
+	return true;
+}
+
+// Parses an .aif image. The returned samples point into the image itself, so it
+// must stay mapped for as long as aif_data is in use.
+void read_aif(const struct MappedFile *aif, AifData *aif_data)
 {
 	aif_data->has_loop = false;
 	aif_data->num_samples = 0;
 
-	unsigned long pos = 0;
-	char chunk_name[5]; chunk_name[4] = '\0';
 	char chunk_type[5]; chunk_type[4] = '\0';
 
+	if (aif->length < 12)
+	{
+		FATAL_ERROR("Input .aif file is too short to hold a FORM Chunk!\n");
+	}
+
 	// Check for FORM Chunk
-	memcpy(chunk_name, &aif->data[pos], 4);
-	pos += 4;
-	if (strcmp(chunk_name, "FORM") != 0)
+	if (memcmp(aif->data, "FORM", 4) != 0)
 	{
+		char chunk_name[5]; chunk_name[4] = '\0';
+		memcpy(chunk_name, aif->data, 4);
 		FATAL_ERROR("Input .aif file has invalid header Chunk '%s'!\n", chunk_name);
 	}
 
 	// Read size of whole file.
-	unsigned long whole_chunk_size = aif->data[pos++] << 24;
-	whole_chunk_size |= (aif->data[pos++] << 16);
-	whole_chunk_size |= (aif->data[pos++] <<  8);
-	whole_chunk_size |= (uint8_t)aif->data[pos++];
-
+	unsigned long whole_chunk_size = read_u32_be(&aif->data[4]);
 	unsigned long expected_whole_chunk_size = aif->length - 8;
 	if (whole_chunk_size != expected_whole_chunk_size)
 	{
@@ -166,8 +278,7 @@ void read_aif(struct Bytes *aif, AifData *aif_data)
 	}
 
 	// Check for AIFF Form Type
-	memcpy(chunk_type, &aif->data[pos], 4);
-	pos += 4;
+	memcpy(chunk_type, &aif->data[8], 4);
 	if (strcmp(chunk_type, "AIFF") != 0)
 	{
 		FATAL_ERROR("FORM Type is '%s', but it must be AIFF!", chunk_type);
@@ -177,138 +288,105 @@ void read_aif(struct Bytes *aif, AifData *aif_data)
 	unsigned short num_markers = 0, loop_start = 0, loop_end = 0;
 	unsigned long num_sample_frames = 0;
 
+	struct ChunkReader reader = { aif->data, aif->length, 12 };
+	struct Chunk chunk;
+
 	// Read all the Chunks to populate the AifData struct.
-	while ((pos + 8) < aif->length)
+	while (next_chunk(&reader, &chunk))
 	{
-		// Read Chunk id
-		memcpy(chunk_name, &aif->data[pos], 4);
-		pos += 4;
-
-		unsigned long chunk_size = (aif->data[pos++] << 24);
-		chunk_size |= (aif->data[pos++] << 16);
-		chunk_size |= (aif->data[pos++] <<  8);
-		chunk_size |=  aif->data[pos++];
+		const uint8_t *body = chunk.data;
 
-		if ((pos + chunk_size) > aif->length)
+		if (strcmp(chunk.name, "COMM") == 0)
 		{
-			FATAL_ERROR("%s chunk at 0x%lx reached end of file before finishing\n", chunk_name, pos);
-		}
+			if (chunk.size < 18)
+			{
+				FATAL_ERROR("COMM Chunk at 0x%lx is too short!\n", chunk.offset);
+			}
 
-		if (strcmp(chunk_name, "COMM") == 0)
-		{
-			short num_channels = (aif->data[pos++] << 8);
-			num_channels |= (uint8_t)aif->data[pos++];
+			short num_channels = read_u16_be(body);
 			if (num_channels != 1)
 			{
 				FATAL_ERROR("numChannels (%d) in the COMM Chunk must be 1!\n", num_channels);
 			}
 
-			num_sample_frames =  (aif->data[pos++] << 24);
-			num_sample_frames |= (aif->data[pos++] << 16);
-			num_sample_frames |= (aif->data[pos++] <<  8);
-			num_sample_frames |=  (uint8_t)aif->data[pos++];
+			num_sample_frames = read_u32_be(body + 2);
 
-			short sample_size = (aif->data[pos++] << 8);
-			sample_size |= (uint8_t)aif->data[pos++];
+			short sample_size = read_u16_be(body + 6);
 			if (sample_size != 8)
 			{
 				FATAL_ERROR("sampleSize (%d) in the COMM Chunk must be 8!\n", sample_size);
 			}
 
-			double sample_rate = ieee754_read_extended((uint8_t*)(aif->data + pos));
-			pos += 10;
-
-			aif_data->sample_rate = sample_rate;
+			aif_data->sample_rate = ieee754_read_extended((uint8_t *)(body + 8));
 
 			if (aif_data->num_samples == 0)
 			{
 				aif_data->num_samples = num_sample_frames;
 			}
 		}
-		else if (strcmp(chunk_name, "MARK") == 0)
+		else if (strcmp(chunk.name, "MARK") == 0)
 		{
-			num_markers = (aif->data[pos++] << 8);
-			num_markers |= (uint8_t)aif->data[pos++];
-
 			if (markers)
 			{
 				FATAL_ERROR("More than one MARK Chunk in file!\n");
 			}
-			
+
+			const uint8_t *end = body + chunk.size;
+			num_markers = read_u16_be(body);
+			body += 2;
+
 			markers = calloc(num_markers, sizeof(struct Marker));
 
 			// Read each marker.
 			for (int i = 0; i < num_markers; i++)
 			{
-				unsigned short marker_id = (aif->data[pos++] << 8);
-				marker_id |= (uint8_t)aif->data[pos++];
-
-				unsigned long marker_position = (aif->data[pos++] << 24);
-				marker_position |= (aif->data[pos++] << 16);
-				marker_position |= (aif->data[pos++] << 8);
-				marker_position |=  (uint8_t)aif->data[pos++];
-
-				// Marker name is a Pascal-style string.
-				uint8_t marker_name_size = aif->data[pos++];
-				// We don't actually need the marker name for anything anymore.
-				/*char *marker_name = (char *)malloc((marker_name_size + 1) * sizeof(char));
-				memcpy(marker_name, &aif->data[pos], marker_name_size);
-				marker_name[marker_name_size] = '\0';*/
-				pos += marker_name_size + !(marker_name_size & 1);
-
-				markers[i].id = marker_id;
-				markers[i].position = marker_position;
+				if (body + 7 > end)
+				{
+					FATAL_ERROR("MARK Chunk at 0x%lx is truncated!\n", chunk.offset);
+				}
+
+				markers[i].id = read_u16_be(body);
+				markers[i].position = read_u32_be(body + 2);
+
+				// Marker name is a Pascal-style string, which we don't need.
+				uint8_t marker_name_size = body[6];
+				body += 7 + marker_name_size + !(marker_name_size & 1);
 			}
 		}
-		else if (strcmp(chunk_name, "INST") == 0)
+		else if (strcmp(chunk.name, "INST") == 0)
 		{
-			uint8_t midi_note = (uint8_t)aif->data[pos++];
-
-			aif_data->midi_note = midi_note;
-
-			// Skip over data we don't need.
-			pos += 7;
+			if (chunk.size < 20)
+			{
+				FATAL_ERROR("INST Chunk at 0x%lx is too short!\n", chunk.offset);
+			}
 
-			unsigned short loop_type = (aif->data[pos++] << 8);
-			loop_type |= (uint8_t)aif->data[pos++];
+			aif_data->midi_note = body[0];
 
+			// Skip over data we don't need, then read the sustain loop.
+			unsigned short loop_type = read_u16_be(body + 8);
 			if (loop_type)
 			{
-				loop_start = (aif->data[pos++] << 8);
-				loop_start |= (uint8_t)aif->data[pos++];
-
-				loop_end = (aif->data[pos++] << 8);
-				loop_end |= (uint8_t)aif->data[pos++];
-			}
-			else
-			{
-				// Skip NoLooping sustain loop.
-				pos += 4;
+				loop_start = read_u16_be(body + 10);
+				loop_end = read_u16_be(body + 12);
 			}
-			
-			// Skip release loop, we don't need it.
-			pos += 6;
-		}
-		else if (strcmp(chunk_name, "SSND") == 0)
-		{
-			// Skip offset and blockSize
-			pos += 8;
-
-			unsigned long num_samples = chunk_size - 8;
-			uint8_t *sample_data = (uint8_t *)malloc(num_samples * sizeof(uint8_t));
-			memcpy(sample_data, &aif->data[pos], num_samples);
 
-			aif_data->samples = sample_data;
-			aif_data->real_num_samples = num_samples;
-			pos += chunk_size - 8;
+			// The release loop is ignored.
 		}
-		else
+		else if (strcmp(chunk.name, "SSND") == 0)
 		{
-			// Skip over unsupported chunks.
-			pos += chunk_size;
+			if (chunk.size < 8)
+			{
+				FATAL_ERROR("SSND Chunk at 0x%lx is too short!\n", chunk.offset);
+			}
+
+			// Skip offset and blockSize
+			aif_data->samples = (uint8_t *)(body + 8);
+			aif_data->real_num_samples = chunk.size - 8;
 		}
+
+		// Unsupported chunks are skipped by next_chunk.
 	}
-	
+
 	if (markers)
 	{
 		// Resolve loop points.
@@ -523,33 +601,26 @@ do { \
 	(var) |= (*((src) + 3) << 24); \
 } while (0)
 
-// Reads an .aif file and produces a .pcm file containing an array of 8-bit samples.
-void aif2pcm(const char *aif_filename, const char *pcm_filename, bool compress)
+// Converts an .aif file into the in-memory contents of a .pcm file, which is
+// a 16-byte header followed by an array of 8-bit samples.
+void convert_aif(const char *aif_filename, bool compress, struct Bytes *output)
 {
-	struct Bytes *aif = read_bytearray(aif_filename);
+	struct MappedFile aif;
+	map_file(aif_filename, &aif);
 	AifData aif_data = {0,0,0,0,0,0,0};
-	read_aif(aif, &aif_data);
+	read_aif(&aif, &aif_data);
 
 	int header_size = 0x10;
-	struct Bytes *pcm;
-	struct Bytes output = {0,0};
+	struct Bytes *pcm = NULL;
+	struct Bytes input = { aif_data.real_num_samples, aif_data.samples };
 
 	if (compress)
 	{
-		struct Bytes *input = malloc(sizeof(struct Bytes));
-		input->data = aif_data.samples;
-		input->length = aif_data.real_num_samples;
-		pcm = delta_compress(input);
-		free(input);
-	}
-	else
-	{
-		pcm = malloc(sizeof(struct Bytes));
-		pcm->data = aif_data.samples;
-		pcm->length = aif_data.real_num_samples;
+		pcm = delta_compress(&input);
+		input = *pcm;
 	}
-	output.length = header_size + pcm->length;
-	output.data = malloc(output.length);
+	output->length = header_size + input.length;
+	output->data = malloc(output->length);
 
 	uint32_t pitch_adjust = (uint32_t)(aif_data.sample_rate * 1024);
 	uint32_t loop_offset = (uint32_t)(aif_data.loop_offset);
@@ -557,18 +628,29 @@ void aif2pcm(const char *aif_filename, const char *pcm_filename, bool compress)
 	uint32_t flags = 0;
 	if (aif_data.has_loop) flags |= 0x40000000;
 	if (compress) flags |= 1;
-	STORE_U32_LE(output.data + 0, flags);
-	STORE_U32_LE(output.data + 4, pitch_adjust);
-	STORE_U32_LE(output.data + 8, loop_offset);
-	STORE_U32_LE(output.data + 12, adjusted_num_samples);
-	memcpy(&output.data[header_size], pcm->data, pcm->length);
-	write_bytearray(pcm_filename, &output);
+	STORE_U32_LE(output->data + 0, flags);
+	STORE_U32_LE(output->data + 4, pitch_adjust);
+	STORE_U32_LE(output->data + 8, loop_offset);
+	STORE_U32_LE(output->data + 12, adjusted_num_samples);
+	if (input.length)
+	{
+		memcpy(&output->data[header_size], input.data, input.length);
+	}
 
-	free(aif->data);
-	free(aif);
-	free(pcm);
+	if (pcm)
+	{
+		free_bytearray(pcm);
+	}
+	unmap_file(&aif);
+}
+
+// Reads an .aif file and produces a .pcm file containing an array of 8-bit samples.
+void aif2pcm(const char *aif_filename, const char *pcm_filename, bool compress)
+{
+	struct Bytes output = {0,0};
+	convert_aif(aif_filename, compress, &output);
+	write_bytearray(pcm_filename, &output);
 	free(output.data);
-	free(aif_data.samples);
 }
 
 // Reads a .pcm file containing an array of 8-bit samples and produces an .aif file.
@@ -821,10 +903,149 @@ void pcm2aif(const char *pcm_filename, const char *aif_filename, uint32_t base_n
 	free(aif);
 }
 
+#ifndef _WIN32
+
+// Returns true if filename already holds exactly the given bytes.
+bool file_matches(const char *filename, const struct Bytes *bytes)
+{
+	struct stat st;
+	if (stat(filename, &st) != 0 || (unsigned long)st.st_size != bytes->length)
+	{
+		return false;
+	}
+
+	FILE *f = fopen(filename, "rb");
+	if (!f)
+	{
+		return false;
+	}
+
+	bool matches = true;
+	uint8_t buffer[0x1000];
+	unsigned long pos = 0;
+	while (matches && pos < bytes->length)
+	{
+		size_t count = fread(buffer, 1, sizeof(buffer), f);
+		if (count == 0)
+		{
+			matches = false;
+			break;
+		}
+		if (pos + count > bytes->length || memcmp(buffer, &bytes->data[pos], count) != 0)
+		{
+			matches = false;
+		}
+		pos += count;
+	}
+	fclose(f);
+	return matches;
+}
+
+static int compare_filenames(const void *a, const void *b)
+{
+	return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+// Converts every .aif file in dirname to a .bin file next to it, spreading the
+// work over one process per CPU. Outputs whose contents didn't change are left
+// untouched so that their timestamps stay put.
+void aif2pcm_batch(const char *dirname, bool compress)
+{
+	DIR *dir = opendir(dirname);
+	if (!dir)
+	{
+		FATAL_ERROR("Failed to open directory '%s'!\n", dirname);
+	}
+
+	char **names = NULL;
+	int num_names = 0, capacity = 0;
+	struct dirent *entry;
+	while ((entry = readdir(dir)) != NULL)
+	{
+		char *extension = get_file_extension(entry->d_name);
+		if (!extension || (strcmp(extension, "aif") != 0 && strcmp(extension, "aiff") != 0))
+		{
+			continue;
+		}
+		if (num_names == capacity)
+		{
+			capacity = capacity ? capacity * 2 : 64;
+			names = realloc(names, capacity * sizeof(char *));
+		}
+		names[num_names] = malloc(strlen(dirname) + 1 + strlen(entry->d_name) + 1);
+		sprintf(names[num_names++], "%s/%s", dirname, entry->d_name);
+	}
+	closedir(dir);
+
+	// Sort so that the work split between processes is deterministic.
+	qsort(names, num_names, sizeof(char *), compare_filenames);
+
+	long num_workers = sysconf(_SC_NPROCESSORS_ONLN);
+	if (num_workers < 1)
+	{
+		num_workers = 1;
+	}
+	if (num_workers > num_names)
+	{
+		num_workers = num_names;
+	}
+
+	for (long worker = 0; worker < num_workers; worker++)
+	{
+		pid_t pid = fork();
+		if (pid < 0)
+		{
+			FATAL_ERROR("Failed to start batch worker!\n");
+		}
+		if (pid > 0)
+		{
+			continue;
+		}
+
+		for (int i = worker; i < num_names; i += num_workers)
+		{
+			struct Bytes output = {0,0};
+			char *pcm_filename = new_file_extension(names[i], "bin");
+			convert_aif(names[i], compress, &output);
+			if (!file_matches(pcm_filename, &output))
+			{
+				write_bytearray(pcm_filename, &output);
+			}
+			free(output.data);
+			free(pcm_filename);
+		}
+		exit(0);
+	}
+
+	bool failed = false;
+	int status;
+	while (wait(&status) > 0)
+	{
+		if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+		{
+			failed = true;
+		}
+	}
+
+	for (int i = 0; i < num_names; i++)
+	{
+		free(names[i]);
+	}
+	free(names);
+
+	if (failed)
+	{
+		FATAL_ERROR("Failed to convert some files in '%s'!\n", dirname);
+	}
+}
+
+#endif // _WIN32
+
 void usage(void)
 {
 	fprintf(stderr, "Usage: aif2pcm bin_file [aif_file]\n");
 	fprintf(stderr, "       aif2pcm aif_file [bin_file] [--compress]\n");
+	fprintf(stderr, "       aif2pcm --batch dir [--compress]\n");
 }
 
 int main(int argc, char **argv)
@@ -835,6 +1056,21 @@ int main(int argc, char **argv)
 		exit(1);
 	}
 
+	if (strcmp(argv[1], "--batch") == 0)
+	{
+		if (argc < 3)
+		{
+			usage();
+			exit(1);
+		}
+#ifndef _WIN32
+		aif2pcm_batch(argv[2], argc > 3 && strcmp(argv[3], "--compress") == 0);
+		return 0;
+#else
+		FATAL_ERROR("--batch is not supported on this platform\n");
+#endif
+	}
+
 	char *input_file = argv[1];
 	char *extension = get_file_extension(input_file);
 	char *output_file;
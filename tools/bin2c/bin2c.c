@@ -88,10 +88,177 @@ int ExtractData(unsigned char *buffer, int offset, int size)
     }
 }
 
+// Output is accumulated here and written out in large chunks instead of
+// going through printf for every element.
+static char sOutBuffer[0x10000];
+static int sOutPos;
+
+static void FlushOutput(void)
+{
+    if (sOutPos != 0 && fwrite(sOutBuffer, sOutPos, 1, stdout) != 1)
+        FATAL_ERROR("Failed to write output.\n");
+
+    sOutPos = 0;
+}
+
+static void Emit(const char *s, int length)
+{
+    if (sOutPos + length > (int)sizeof(sOutBuffer))
+        FlushOutput();
+
+    if (length > (int)sizeof(sOutBuffer))
+    {
+        if (fwrite(s, length, 1, stdout) != 1)
+            FATAL_ERROR("Failed to write output.\n");
+        return;
+    }
+
+    memcpy(&sOutBuffer[sOutPos], s, length);
+    sOutPos += length;
+}
+
+static const char sHexDigits[] = "0123456789abcdef";
+
+// Formats one element exactly like printf's "%*d, ", "%*uu, " or "%#*xu, ".
+// As with printf, a negative pad left-justifies the number in -pad columns.
+static int FormatElement(char *out, int data, int pad, bool isDecimal, bool isSigned)
+{
+    char digits[16];
+    int numDigits = 0;
+    unsigned int value = data;
+    bool isNegative = false;
+    bool isLeftJustified = pad < 0;
+
+    if (isLeftJustified)
+        pad = -pad;
+
+    if (isDecimal && isSigned && data < 0)
+    {
+        isNegative = true;
+        value = -value;
+    }
+
+    if (isDecimal)
+    {
+        do
+        {
+            digits[numDigits++] = '0' + value % 10;
+            value /= 10;
+        } while (value != 0);
+    }
+    else
+    {
+        do
+        {
+            digits[numDigits++] = sHexDigits[value & 0xF];
+            value >>= 4;
+        } while (value != 0);
+    }
+
+    // "%#x" only adds the prefix for nonzero values.
+    bool hasPrefix = !isDecimal && data != 0;
+    int width = numDigits + isNegative + (hasPrefix ? 2 : 0);
+    int length = 0;
+
+    while (!isLeftJustified && width < pad)
+    {
+        out[length++] = ' ';
+        width++;
+    }
+
+    if (isNegative)
+        out[length++] = '-';
+
+    if (hasPrefix)
+    {
+        out[length++] = '0';
+        out[length++] = 'x';
+    }
+
+    while (numDigits > 0)
+        out[length++] = digits[--numDigits];
+
+    while (width < pad)
+    {
+        out[length++] = ' ';
+        width++;
+    }
+
+    if (!isDecimal || !isSigned)
+        out[length++] = 'u';
+
+    out[length++] = ',';
+    out[length++] = ' ';
+    return length;
+}
+
+// Emits the array as C source. Byte-sized elements are formatted once per
+// possible value and then looked up.
+static void EmitCArray(unsigned char *buffer, int fileSize, int size, int col, int pad, bool isDecimal, bool isSigned)
+{
+    int stride = abs(pad) + 32;
+    char *table = malloc(257 * stride);
+    int tableLengths[256];
+    char *element = &table[256 * stride];
+    int count = fileSize / size;
+    int offset = 0;
+
+    if (table == NULL)
+        FATAL_ERROR("Failed to allocate memory for the format table.\n");
+
+    if (size == 1)
+    {
+        for (int i = 0; i < 256; i++)
+            tableLengths[i] = FormatElement(&table[i * stride], i, pad, isDecimal, isSigned);
+    }
+
+    for (int i = 0; i < count; i++)
+    {
+        if (i % col == 0)
+            Emit("\n    ", 5);
+
+        if (size == 1)
+            Emit(&table[buffer[offset] * stride], tableLengths[buffer[offset]]);
+        else
+            Emit(element, FormatElement(element, ExtractData(buffer, offset, size), pad, isDecimal, isSigned));
+
+        offset += size;
+    }
+
+    free(table);
+    FlushOutput();
+}
+
+// Emits an assembly file that pulls the input in with .incbin, so the
+// compiler never has to parse the data.
+static void EmitIncbin(char *path, char *var_name, int size)
+{
+    printf("@ Generated file. Do not edit.\n\n");
+    printf("\t.section .rodata\n");
+    printf("\t.global %s\n", var_name);
+    printf("\t.align %d\n", size == 4 ? 2 : size == 2 ? 1 : 0);
+    printf("%s:\n", var_name);
+    printf("\t.incbin \"%s\"\n", path);
+    printf("\t.size %s, .-%s\n", var_name, var_name);
+}
+
+static void WriteHeader(char *path, char *var_name, int size, bool isSigned, int count)
+{
+    FILE *fp = fopen(path, "w");
+
+    if (fp == NULL)
+        FATAL_ERROR("Failed to open \"%s\" for writing.\n", path);
+
+    fprintf(fp, "// Generated file. Do not edit.\n\n");
+    fprintf(fp, "extern const %c%d %s[%d];\n", isSigned ? 's' : 'u', 8 * size, var_name, count);
+    fclose(fp);
+}
+
 int main(int argc, char **argv)
 {
     if (argc < 3)
-        FATAL_ERROR("Usage: bin2c INPUT_FILE VAR_NAME [OPTIONS...]\n");
+        FATAL_ERROR("Usage: bin2c INPUT_FILE VAR_NAME [OPTIONS...]\n"
+                    "Options: -col N -pad N -size 1|2|4 -signed -static -decimal -incbin -header FILE\n");
 
     int fileSize;
     unsigned char *buffer = ReadWholeFile(argv[1], &fileSize);
@@ -102,6 +269,8 @@ int main(int argc, char **argv)
     bool isSigned = false;
     bool isStatic = false;
     bool isDecimal = false;
+    bool isIncbin = false;
+    char *headerPath = NULL;
 
     for (int i = 3; i < argc; i++)
     {
@@ -148,6 +317,19 @@ int main(int argc, char **argv)
         {
             isDecimal = true;
         }
+        else if (!strcmp(argv[i], "-incbin"))
+        {
+            isIncbin = true;
+        }
+        else if (!strcmp(argv[i], "-header"))
+        {
+            i++;
+
+            if (i >= argc)
+                FATAL_ERROR("Missing argument after '-header'.\n");
+
+            headerPath = argv[i];
+        }
         else
         {
             FATAL_ERROR("Unrecognized option '%s'.\n", argv[i]);
@@ -157,6 +339,18 @@ int main(int argc, char **argv)
     if ((fileSize & (size - 1)) != 0)
         FATAL_ERROR("Size %d doesn't evenly divide file size %d.\n", size, fileSize);
 
+    if (headerPath != NULL)
+        WriteHeader(headerPath, var_name, size, isSigned, fileSize / size);
+
+    if (isIncbin)
+    {
+        if (isStatic)
+            FATAL_ERROR("'-static' can't be used with '-incbin'.\n");
+
+        EmitIncbin(argv[1], var_name, size);
+        return 0;
+    }
+
     printf("// Generated file. Do not edit.\n\n");
 
     if (isStatic)
@@ -170,30 +364,9 @@ int main(int argc, char **argv)
         printf("u%d ", 8 * size);
 
     printf("%s[] =\n{", var_name);
+    fflush(stdout);
 
-    int count = fileSize / size;
-    int offset = 0;
-
-    for (int i = 0; i < count; i++)
-    {
-        if (i % col == 0)
-            printf("\n    ");
-
-        int data = ExtractData(buffer, offset, size);
-        offset += size;
-
-        if (isDecimal)
-        {
-            if (isSigned)
-                printf("%*d, ", pad, data);
-            else
-                printf("%*uu, ", pad, data);
-        }
-        else
-        {
-            printf("%#*xu, ", pad, data);
-        }
-    }
+    EmitCArray(buffer, fileSize, size, col, pad, isDecimal, isSigned);
 
     printf("\n};\n");
 
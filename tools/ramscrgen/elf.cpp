@@ -1,272 +1,536 @@
 #include <cstdio>
 #include <cstring>
 #include <cstdint>
+#include <cstdlib>
 #include <map>
 #include <vector>
 #include <string>
+#include <sys/stat.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 #include "ramscrgen.h"
 #include "elf.h"
 
 #define SHN_COMMON 0xFFF2
 
-static std::string s_elfPath;
-static std::string s_archiveFilePath;
-static std::string s_archiveObjectPath;
+// A read-only view of a whole file. On POSIX hosts the file is mmapped, so
+// section and string tables are read in place rather than copied out.
+class MappedFile
+{
+public:
+    MappedFile(std::string path);
+    MappedFile(const MappedFile&) = delete;
+    ~MappedFile();
+    const std::uint8_t* Data() const { return m_data; }
+    std::size_t Size() const { return m_size; }
+
+private:
+    const std::uint8_t* m_data;
+    std::size_t m_size;
+    bool m_mapped;
+};
 
-static FILE *s_file;
+MappedFile::MappedFile(std::string path) : m_data(nullptr), m_size(0), m_mapped(false)
+{
+#ifndef _WIN32
+    int fd = open(path.c_str(), O_RDONLY);
 
-static std::uint32_t s_sectionHeaderOffset;
-static int s_sectionHeaderEntrySize;
-static int s_sectionCount;
-static int s_shstrtabIndex;
+    if (fd < 0)
+        FATAL_ERROR("error: failed to open \"%s\" for reading\n", path.c_str());
 
-static std::uint32_t s_symtabOffset;
-static std::uint32_t s_strtabOffset;
+    struct stat st;
 
-static std::uint32_t s_symbolCount;
-static std::uint32_t s_elfFileOffset;
+    if (fstat(fd, &st) != 0)
+        FATAL_ERROR("error: failed to stat \"%s\"\n", path.c_str());
 
-struct Symbol
-{
-    std::uint32_t nameOffset;
-    std::uint32_t size;
-};
+    m_size = st.st_size;
 
-static void Seek(long offset)
-{
-    if (std::fseek(s_file, s_elfFileOffset + offset, SEEK_SET) != 0)
-        FATAL_ERROR("error: failed to seek to %ld in \"%s\"", offset, s_elfPath.c_str());
+    if (m_size != 0)
+    {
+        void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (data == MAP_FAILED)
+            FATAL_ERROR("error: failed to map \"%s\"\n", path.c_str());
+
+        m_data = static_cast<const std::uint8_t*>(data);
+        m_mapped = true;
+    }
+
+    close(fd);
+#else
+    FILE* fp = std::fopen(path.c_str(), "rb");
+
+    if (fp == NULL)
+        FATAL_ERROR("error: failed to open \"%s\" for reading\n", path.c_str());
+
+    std::fseek(fp, 0, SEEK_END);
+    m_size = std::ftell(fp);
+    std::rewind(fp);
+
+    std::uint8_t* buffer = new std::uint8_t[m_size + 1];
+
+    if (m_size != 0 && std::fread(buffer, m_size, 1, fp) != 1)
+        FATAL_ERROR("error: failed to read \"%s\"\n", path.c_str());
+
+    std::fclose(fp);
+    m_data = buffer;
+#endif
 }
 
-static void Skip(long offset)
+MappedFile::~MappedFile()
 {
-    if (std::fseek(s_file, offset, SEEK_CUR) != 0)
-        FATAL_ERROR("error: failed to skip %ld bytes in \"%s\"", offset, s_elfPath.c_str());
+#ifndef _WIN32
+    if (m_mapped)
+        munmap(const_cast<std::uint8_t*>(m_data), m_size);
+#else
+    delete[] m_data;
+#endif
 }
 
-static std::uint32_t ReadInt8()
+// A bounds-checked little-endian reader over the ELF object inside an image.
+// For archive members, the object starts somewhere after the archive headers.
+class ElfView
 {
-    int c = std::fgetc(s_file);
+public:
+    ElfView(const std::uint8_t* data, std::size_t size, std::string path)
+        : m_data(data), m_size(size), m_path(path) {}
+
+    std::uint32_t ReadInt16(std::uint32_t offset) const
+    {
+        Check(offset, 2);
+        return m_data[offset] | (m_data[offset + 1] << 8);
+    }
 
-    if (c < 0)
-        FATAL_ERROR("error: unexpected EOF when reading ELF file \"%s\"\n", s_elfPath.c_str());
+    std::uint32_t ReadInt32(std::uint32_t offset) const
+    {
+        Check(offset, 4);
+        return m_data[offset]
+            | (m_data[offset + 1] << 8)
+            | (m_data[offset + 2] << 16)
+            | ((std::uint32_t)m_data[offset + 3] << 24);
+    }
 
-    return c;
-}
+    // Returns a pointer to the NUL-terminated string at offset, without copying it.
+    const char* GetString(std::uint32_t offset) const
+    {
+        Check(offset, 1);
+        const void* end = std::memchr(m_data + offset, 0, m_size - offset);
+
+        if (end == nullptr)
+            FATAL_ERROR("error: unterminated string at 0x%X in \"%s\"\n", offset, m_path.c_str());
+
+        return reinterpret_cast<const char*>(m_data + offset);
+    }
 
-static std::uint32_t ReadInt16()
+    const std::uint8_t* Data() const { return m_data; }
+    std::size_t Size() const { return m_size; }
+    const std::string& Path() const { return m_path; }
+
+private:
+    const std::uint8_t* m_data;
+    std::size_t m_size;
+    std::string m_path;
+
+    void Check(std::uint32_t offset, std::uint32_t length) const
+    {
+        if ((std::uint64_t)offset + length > m_size)
+            FATAL_ERROR("error: unexpected EOF when reading ELF file \"%s\"\n", m_path.c_str());
+    }
+};
+
+struct SectionInfo
 {
-    std::uint32_t val = 0;
-    val |= ReadInt8();
-    val |= ReadInt8() << 8;
-    return val;
-}
+    std::uint32_t offset;
+    std::uint32_t size;
+};
 
-static std::uint32_t ReadInt32()
+static void VerifyElfIdent(const ElfView& elf)
 {
-    std::uint32_t val = 0;
-    val |= ReadInt8();
-    val |= ReadInt8() << 8;
-    val |= ReadInt8() << 16;
-    val |= ReadInt8() << 24;
-    return val;
+    const std::uint8_t expectedMagic[4] = { 0x7F, 'E', 'L', 'F' };
+
+    if (elf.Size() < 0x34)
+        FATAL_ERROR("error: failed to read ELF header from \"%s\"\n", elf.Path().c_str());
+
+    if (std::memcmp(elf.Data(), expectedMagic, 4) != 0)
+        FATAL_ERROR("error: ELF magic did not match in \"%s\"\n", elf.Path().c_str());
+
+    if (elf.Data()[4] != 1)
+        FATAL_ERROR("error: \"%s\" not 32-bit ELF\n", elf.Path().c_str());
+
+    if (elf.Data()[5] != 1)
+        FATAL_ERROR("error: \"%s\" not little-endian ELF\n", elf.Path().c_str());
 }
 
-static std::string ReadString()
+static ElfView FindArObj(const MappedFile& archive, std::string archivePath, std::string objectPath)
 {
-    std::string s;
-    char c;
+    const char expectedMagic[8] = {'!', '<', 'a', 'r', 'c', 'h', '>', '\n'};
+    const char expectedEndMagic[2] = { 0x60, 0x0a };
+    const std::uint8_t* data = archive.Data();
+    std::size_t size = archive.Size();
+
+    if (size < 8)
+        FATAL_ERROR("error: failed to read AR magic from \"%s\"\n", archivePath.c_str());
+
+    if (std::memcmp(data, expectedMagic, 8) != 0)
+        FATAL_ERROR("error: AR magic did not match in \"%s\"\n", archivePath.c_str());
+
+    std::size_t pos = 8;
+
+    while (pos + 60 <= size)
+    {
+        char file_ident[17] = {0};
+        char filesize_s[11] = {0};
+
+        std::memcpy(file_ident, data + pos, 16);
+        std::memcpy(filesize_s, data + pos + 48, 10);
+
+        if (std::memcmp(data + pos + 58, expectedEndMagic, 2) != 0)
+            FATAL_ERROR("error: corrupted archive header in \"%s\" at \"%s\"\n", archivePath.c_str(), file_ident);
 
-    while ((c = ReadInt8()) != 0)
-        s += c;
+        char * ptr = std::strchr(file_ident, '/');
+        if (ptr != nullptr)
+            *ptr = 0;
+
+        std::size_t filesize = std::strtoul(filesize_s, nullptr, 10);
+        pos += 60;
+
+        if (pos + filesize > size)
+            FATAL_ERROR("error: archive member \"%s\" runs past the end of \"%s\"\n", file_ident, archivePath.c_str());
+
+        if (std::strncmp(objectPath.c_str(), file_ident, 16) == 0)
+            return ElfView(data + pos, filesize, archivePath + ":" + objectPath);
+
+        // Members are padded to an even offset.
+        pos += filesize + (filesize & 1);
+    }
 
-    return s;
+    FATAL_ERROR("error: could not find object \"%s\" in archive \"%s\"\n", objectPath.c_str(), archivePath.c_str());
 }
 
-static void VerifyElfIdent()
+static std::map<std::string, std::uint32_t> GetCommonSymbols_Shared(const ElfView& elf)
 {
-    char expectedMagic[4] = { 0x7F, 'E', 'L', 'F' };
-    char magic[4];
+    VerifyElfIdent(elf);
+
+    std::uint32_t sectionHeaderOffset = elf.ReadInt32(0x20);
+    std::uint32_t sectionHeaderEntrySize = elf.ReadInt16(0x2E);
+    std::uint32_t sectionCount = elf.ReadInt16(0x30);
+    std::uint32_t shstrtabIndex = elf.ReadInt16(0x32);
+
+    auto getSection = [&](std::uint32_t index) {
+        std::uint32_t header = sectionHeaderOffset + sectionHeaderEntrySize * index;
+        SectionInfo info;
+        info.offset = elf.ReadInt32(header + 0x10);
+        info.size = elf.ReadInt32(header + 0x14);
+        return info;
+    };
+
+    SectionInfo shstrtab = getSection(shstrtabIndex);
+    SectionInfo symtab = {};
+    SectionInfo strtab = {};
+
+    for (std::uint32_t i = 0; i < sectionCount; i++)
+    {
+        std::uint32_t nameOffset = elf.ReadInt32(sectionHeaderOffset + sectionHeaderEntrySize * i);
+        const char* name = elf.GetString(shstrtab.offset + nameOffset);
+
+        if (std::strcmp(name, ".symtab") == 0)
+        {
+            if (symtab.offset)
+                FATAL_ERROR("error: mutiple .symtab sections found in \"%s\"\n", elf.Path().c_str());
+            symtab = getSection(i);
+        }
+        else if (std::strcmp(name, ".strtab") == 0)
+        {
+            if (strtab.offset)
+                FATAL_ERROR("error: mutiple .strtab sections found in \"%s\"\n", elf.Path().c_str());
+            strtab = getSection(i);
+        }
+    }
+
+    if (!symtab.offset)
+        FATAL_ERROR("error: couldn't find .symtab section in \"%s\"\n", elf.Path().c_str());
 
-    if (std::fread(magic, 4, 1, s_file) != 1)
-        FATAL_ERROR("error: failed to read ELF magic from \"%s\"\n", s_elfPath.c_str());
+    if (!strtab.offset)
+        FATAL_ERROR("error: couldn't find .strtab section in \"%s\"\n", elf.Path().c_str());
 
-    if (std::memcmp(magic, expectedMagic, 4) != 0)
-        FATAL_ERROR("error: ELF magic did not match in \"%s\"\n", s_elfPath.c_str());
+    std::map<std::string, std::uint32_t> commonSymbols;
+    std::uint32_t symbolCount = symtab.size / 16;
 
-    if (std::fgetc(s_file) != 1)
-        FATAL_ERROR("error: \"%s\" not 32-bit ELF\n", s_elfPath.c_str());
+    for (std::uint32_t i = 0; i < symbolCount; i++)
+    {
+        std::uint32_t entry = symtab.offset + i * 16;
 
-    if (std::fgetc(s_file) != 1)
-        FATAL_ERROR("error: \"%s\" not little-endian ELF\n", s_elfPath.c_str());
+        if (elf.ReadInt16(entry + 14) == SHN_COMMON)
+            commonSymbols[elf.GetString(strtab.offset + elf.ReadInt32(entry))] = elf.ReadInt32(entry + 8);
+    }
+
+    return commonSymbols;
 }
 
-static void VerifyAr()
+#define SHT_NOBITS 8
+
+std::vector<BssSection> GetBssSections(std::string path)
 {
-    char expectedMagic[8] = {'!', '<', 'a', 'r', 'c', 'h', '>', '\n'};
-    char magic[8];
+    MappedFile file(path);
+    ElfView elf(file.Data(), file.Size(), path);
+
+    VerifyElfIdent(elf);
 
-    if (std::fread(magic, 8, 1, s_file) != 1)
-        FATAL_ERROR("error: failed to read AR magic from \"%s\"\n", s_archiveFilePath.c_str());
+    std::uint32_t sectionHeaderOffset = elf.ReadInt32(0x20);
+    std::uint32_t sectionHeaderEntrySize = elf.ReadInt16(0x2E);
+    std::uint32_t sectionCount = elf.ReadInt16(0x30);
+    std::uint32_t shstrtabIndex = elf.ReadInt16(0x32);
+    std::uint32_t shstrtabOffset = elf.ReadInt32(sectionHeaderOffset + sectionHeaderEntrySize * shstrtabIndex + 0x10);
 
-    if (std::memcmp(magic, expectedMagic, 8) != 0)
-        FATAL_ERROR("error: AR magic did not match in \"%s\"\n", s_archiveFilePath.c_str());
+    std::vector<BssSection> sections;
+
+    for (std::uint32_t i = 0; i < sectionCount; i++)
+    {
+        std::uint32_t header = sectionHeaderOffset + sectionHeaderEntrySize * i;
+
+        if (elf.ReadInt32(header + 0x04) != SHT_NOBITS)
+            continue;
+
+        const char* name = elf.GetString(shstrtabOffset + elf.ReadInt32(header));
+
+        // Only per-symbol sections (from -fdata-sections) can be placed individually.
+        if (std::strncmp(name, ".bss.", 5) != 0)
+            continue;
+
+        BssSection section;
+        section.name = name;
+        section.size = elf.ReadInt32(header + 0x14);
+        section.alignment = elf.ReadInt32(header + 0x20);
+        if (section.alignment == 0)
+            section.alignment = 1;
+        sections.push_back(section);
+    }
+
+    return sections;
 }
 
-static void ReadElfHeader()
+// Common symbol tables are cached per object, keyed by the object's path,
+// modification time and size. The cache lives across runs in an optional
+// text file so that relinking after editing one source file only has to
+// re-read that file's object.
+//
+// Each object is a line of tab-separated fields, "path mtime size count",
+// followed by count lines of "symbol size". Fields are split from the right,
+// so paths may contain spaces.
+struct CacheEntry
 {
-    Seek(0x20);
-    s_sectionHeaderOffset = ReadInt32();
-    Seek(0x2E);
-    s_sectionHeaderEntrySize = ReadInt16();
-    s_sectionCount = ReadInt16();
-    s_shstrtabIndex = ReadInt16();
-}
+    std::int64_t mtime;
+    std::int64_t size;
+    bool used;
+    std::map<std::string, std::uint32_t> symbols;
+};
 
-static void FindArObj()
+static std::map<std::string, CacheEntry> s_cache;
+static std::string s_cachePath;
+static bool s_cacheDirty;
+
+// Reads one line without its newline. Returns false at the end of the file.
+static bool ReadCacheLine(FILE* fp, std::string& line)
 {
-    char file_ident[17] = {0};
-    char filesize_s[11] = {0};
-    char expectedEndMagic[2] = { 0x60, 0x0a };
-    char end_magic[2];
-    std::size_t filesize;
-
-    Seek(8);
-    while (!std::feof(s_file)) {
-        if (std::fread(file_ident, 16, 1, s_file) != 1)
-            FATAL_ERROR("error: failed to read file ident in \"%s\"\n", s_archiveFilePath.c_str());
-        Skip(32);
-        if (std::fread(filesize_s, 10, 1, s_file) != 1)
-            FATAL_ERROR("error: failed to read filesize in \"%s\"\n", s_archiveFilePath.c_str());
-        if (std::fread(end_magic, 2, 1, s_file) != 1)
-            FATAL_ERROR("error: failed to read end sentinel in \"%s\"\n", s_archiveFilePath.c_str());
-        if (std::memcmp(end_magic, expectedEndMagic, 2) != 0)
-            FATAL_ERROR("error: corrupted archive header in \"%s\" at \"%s\"\n", s_archiveFilePath.c_str(), file_ident);
+    char buffer[kMaxPath];
 
-        char * ptr = std::strchr(file_ident, '/');
-        if (ptr != nullptr)
-            *ptr = 0;
-        filesize = std::strtoul(filesize_s, nullptr, 10);
-        if (std::strncmp(s_archiveObjectPath.c_str(), file_ident, 16) == 0) {
-            s_elfFileOffset = std::ftell(s_file);
-            return;
+    line.clear();
+
+    while (std::fgets(buffer, sizeof(buffer), fp) != NULL)
+    {
+        line += buffer;
+        if (!line.empty() && line.back() == '\n')
+        {
+            line.pop_back();
+            return true;
         }
-        Skip(filesize);
     }
 
-    FATAL_ERROR("error: could not find object \"%s\" in archive \"%s\"\n", s_archiveObjectPath.c_str(), s_archiveFilePath.c_str());
+    return !line.empty();
 }
 
-static std::string GetSectionName(std::uint32_t shstrtabOffset, int index)
+// Splits the last numFields tab-separated numbers off the end of line, leaving
+// whatever precedes them in line. Returns false if they aren't all there.
+static bool SplitCacheFields(std::string& line, long long* fields, int numFields)
 {
-    Seek(s_sectionHeaderOffset + s_sectionHeaderEntrySize * index);
-    std::uint32_t nameOffset = ReadInt32();
-    Seek(shstrtabOffset + nameOffset);
-    return ReadString();
+    for (int i = numFields - 1; i >= 0; i--)
+    {
+        std::size_t tabPos = line.rfind('\t');
+        if (tabPos == std::string::npos)
+            return false;
+
+        const char* start = line.c_str() + tabPos + 1;
+        char* end;
+        fields[i] = std::strtoll(start, &end, 10);
+        if (end == start || *end != 0)
+            return false;
+
+        line.erase(tabPos);
+    }
+
+    return !line.empty();
 }
 
-static void FindTableOffsets()
+void LoadCommonSymbolCache(std::string path)
 {
-    s_symtabOffset = 0;
-    s_strtabOffset = 0;
+    s_cachePath = path;
+    s_cacheDirty = false;
 
-    Seek(s_sectionHeaderOffset + s_sectionHeaderEntrySize * s_shstrtabIndex + 0x10);
-    std::uint32_t shstrtabOffset = ReadInt32();
+    FILE* fp = std::fopen(path.c_str(), "r");
 
-    for (int i = 0; i < s_sectionCount; i++)
+    // A missing or unreadable cache just means everything gets parsed.
+    if (fp == NULL)
+        return;
+
+    std::string line;
+    bool valid = true;
+
+    while (valid && ReadCacheLine(fp, line))
     {
-        std::string name = GetSectionName(shstrtabOffset, i);
+        long long header[3];
 
-        if (name == ".symtab")
+        if (!SplitCacheFields(line, header, 3) || header[2] < 0)
         {
-            if (s_symtabOffset)
-                FATAL_ERROR("error: mutiple .symtab sections found in \"%s\"\n", s_elfPath.c_str());
-            Seek(s_sectionHeaderOffset + s_sectionHeaderEntrySize * i + 0x10);
-            s_symtabOffset = ReadInt32();
-            std::uint32_t size = ReadInt32();
-            s_symbolCount = size / 16;
+            valid = false;
+            break;
         }
-        else if (name == ".strtab")
+
+        std::string key = line;
+        CacheEntry entry;
+        entry.mtime = header[0];
+        entry.size = header[1];
+        entry.used = false;
+
+        for (long long i = 0; i < header[2]; i++)
         {
-            if (s_strtabOffset)
-                FATAL_ERROR("error: mutiple .strtab sections found in \"%s\"\n", s_elfPath.c_str());
-            Seek(s_sectionHeaderOffset + s_sectionHeaderEntrySize * i + 0x10);
-            s_strtabOffset = ReadInt32();
+            long long symSize;
+
+            if (!ReadCacheLine(fp, line) || !SplitCacheFields(line, &symSize, 1))
+            {
+                valid = false;
+                break;
+            }
+
+            entry.symbols[line] = symSize;
         }
+
+        if (valid)
+            s_cache[key] = entry;
     }
 
-    if (!s_symtabOffset)
-        FATAL_ERROR("error: couldn't find .symtab section in \"%s\"\n", s_elfPath.c_str());
+    std::fclose(fp);
 
-    if (!s_strtabOffset)
-        FATAL_ERROR("error: couldn't find .strtab section in \"%s\"\n", s_elfPath.c_str());
+    // Anything that doesn't parse, including caches written in an older
+    // format, is thrown away and rebuilt.
+    if (!valid)
+    {
+        s_cache.clear();
+        s_cacheDirty = true;
+    }
 }
 
-static std::map<std::string, std::uint32_t> GetCommonSymbols_Shared()
+void SaveCommonSymbolCache()
 {
-    VerifyElfIdent();
-    ReadElfHeader();
-    FindTableOffsets();
+    if (s_cachePath.empty())
+        return;
 
-    std::map<std::string, std::uint32_t> commonSymbols;
+    // Drop objects that are no longer part of the link.
+    for (auto it = s_cache.begin(); it != s_cache.end();)
+    {
+        if (!it->second.used)
+        {
+            it = s_cache.erase(it);
+            s_cacheDirty = true;
+        }
+        else
+        {
+            ++it;
+        }
+    }
 
-    std::vector<Symbol> commonSymbolVec;
+    if (!s_cacheDirty)
+        return;
 
-    Seek(s_symtabOffset);
+    FILE* fp = std::fopen(s_cachePath.c_str(), "w");
 
-    for (std::uint32_t i = 0; i < s_symbolCount; i++)
-    {
-        Symbol sym;
-        sym.nameOffset = ReadInt32();
-        Skip(4);
-        sym.size = ReadInt32();
-        Skip(2);
-        std::uint16_t sectionIndex = ReadInt16();
-        if (sectionIndex == SHN_COMMON)
-            commonSymbolVec.push_back(sym);
-    }
+    if (fp == NULL)
+        FATAL_ERROR("error: failed to open \"%s\" for writing\n", s_cachePath.c_str());
 
-    for (const Symbol& sym : commonSymbolVec)
+    for (const auto& pair : s_cache)
     {
-        Seek(s_strtabOffset + sym.nameOffset);
-        std::string name = ReadString();
-        commonSymbols[name] = sym.size;
+        const CacheEntry& entry = pair.second;
+        std::fprintf(fp, "%s\t%lld\t%lld\t%lu\n", pair.first.c_str(), (long long)entry.mtime, (long long)entry.size, (unsigned long)entry.symbols.size());
+        for (const auto& sym : entry.symbols)
+            std::fprintf(fp, "%s\t%lu\n", sym.first.c_str(), (unsigned long)sym.second);
     }
 
-    return commonSymbols;
+    std::fclose(fp);
 }
 
-std::map<std::string, std::uint32_t> GetCommonSymbolsFromLib(std::string sourcePath, std::string libpath)
+static std::map<std::string, std::uint32_t> ParseCommonSymbols(std::string path, std::string filePath)
 {
-    std::size_t colonPos = libpath.find(':');
-    if (colonPos == std::string::npos)
-        FATAL_ERROR("error: missing colon separator in libfile \"%s\"\n", s_elfPath.c_str());
-
-    s_archiveObjectPath = libpath.substr(colonPos + 1);
-    s_archiveFilePath = sourcePath + "/" + libpath.substr(1, colonPos - 1);
-    s_elfPath = sourcePath + "/" + libpath.substr(1);
-
-    s_file = std::fopen(s_archiveFilePath.c_str(), "rb");
+    if (path[0] == '*')
+    {
+        std::size_t colonPos = path.find(':');
+        std::string objectPath = path.substr(colonPos + 1);
+        MappedFile archive(filePath);
+        return GetCommonSymbols_Shared(FindArObj(archive, filePath, objectPath));
+    }
 
-    if (s_file == NULL)
-        FATAL_ERROR("error: failed to open \"%s\" for reading\n", s_archiveFilePath.c_str());
+    MappedFile file(filePath);
+    return GetCommonSymbols_Shared(ElfView(file.Data(), file.Size(), filePath));
+}
 
-    VerifyAr();
-    FindArObj();
-    return GetCommonSymbols_Shared();
+// Modification time in nanoseconds, where the host provides that resolution.
+static std::int64_t GetModificationTime(const struct stat& st)
+{
+#if defined(__APPLE__)
+    return (std::int64_t)st.st_mtimespec.tv_sec * 1000000000 + st.st_mtimespec.tv_nsec;
+#elif defined(_WIN32)
+    return (std::int64_t)st.st_mtime * 1000000000;
+#else
+    return (std::int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+#endif
 }
 
 std::map<std::string, std::uint32_t> GetCommonSymbols(std::string sourcePath, std::string path)
 {
-    s_elfFileOffset = 0;
+    std::string filePath;
+
     if (path[0] == '*')
-        return GetCommonSymbolsFromLib(sourcePath, path);
+    {
+        std::size_t colonPos = path.find(':');
+        if (colonPos == std::string::npos)
+            FATAL_ERROR("error: missing colon separator in libfile \"%s\"\n", path.c_str());
+        filePath = sourcePath + "/" + path.substr(1, colonPos - 1);
+    }
+    else
+    {
+        filePath = sourcePath + "/" + path;
+    }
 
-    s_elfPath = sourcePath + "/" + path;
-    s_file = std::fopen(s_elfPath.c_str(), "rb");
+    struct stat st;
 
-    if (s_file == NULL)
-        FATAL_ERROR("error: failed to open \"%s\" for reading\n", path.c_str());
+    if (stat(filePath.c_str(), &st) != 0)
+        FATAL_ERROR("error: failed to open \"%s\" for reading\n", filePath.c_str());
+
+    std::string key = sourcePath + "/" + path;
+    auto it = s_cache.find(key);
+
+    if (it != s_cache.end() && it->second.mtime == GetModificationTime(st) && it->second.size == (std::int64_t)st.st_size)
+    {
+        it->second.used = true;
+        return it->second.symbols;
+    }
 
-    return GetCommonSymbols_Shared();
+    CacheEntry& entry = s_cache[key];
+    entry.mtime = GetModificationTime(st);
+    entry.size = st.st_size;
+    entry.used = true;
+    entry.symbols = ParseCommonSymbols(path, filePath);
+    s_cacheDirty = true;
+    return entry.symbols;
 }
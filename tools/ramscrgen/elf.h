@@ -24,7 +24,18 @@
 #include <cstdint>
 #include <map>
 #include <string>
+#include <vector>
+
+struct BssSection
+{
+    std::string name;
+    std::uint32_t size;
+    std::uint32_t alignment;
+};
 
 std::map<std::string, std::uint32_t> GetCommonSymbols(std::string sourcePath, std::string path);
+void LoadCommonSymbolCache(std::string path);
+void SaveCommonSymbolCache();
+std::vector<BssSection> GetBssSections(std::string path);
 
 #endif // ELF_H
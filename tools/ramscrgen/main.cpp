@@ -21,9 +21,11 @@
 #include <cstdio>
 #include <cstring>
 #include <string>
+#include <vector>
 #include "ramscrgen.h"
 #include "sym_file.h"
 #include "elf.h"
+#include "pack.h"
 
 void HandleCommonInclude(std::string filename, std::string sourcePath, std::string symOrderPath, std::string lang)
 {
@@ -140,11 +142,57 @@ void ConvertSymFile(std::string filename, std::string sectionName, std::string l
     }
 }
 
+int HandlePack(int argc, char **argv)
+{
+    if (argc < 5)
+    {
+        fprintf(stderr, "Usage: %s --pack BASE_DIR IWRAM_OUT EWRAM_OUT [--profile FILE] [--iwram-limit SIZE] OBJECT...", argv[0]);
+        return 1;
+    }
+
+    std::string baseDir = std::string(argv[2]);
+    std::string iwramOut = std::string(argv[3]);
+    std::string ewramOut = std::string(argv[4]);
+    std::string profilePath;
+    unsigned long iwramLimit = 0;
+    std::vector<std::string> objects;
+
+    for (int i = 5; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--profile") == 0 || std::strcmp(argv[i], "--iwram-limit") == 0)
+        {
+            if (i + 1 >= argc)
+                FATAL_ERROR("error: missing value after \"%s\"\n", argv[i]);
+
+            if (argv[i][2] == 'p')
+            {
+                profilePath = std::string(argv[++i]);
+            }
+            else
+            {
+                char *end;
+                iwramLimit = std::strtoul(argv[++i], &end, 0);
+                if (*end != 0)
+                    FATAL_ERROR("error: invalid size \"%s\"\n", argv[i]);
+            }
+            continue;
+        }
+
+        objects.push_back(std::string(argv[i]));
+    }
+
+    PackRam(baseDir, objects, iwramOut, ewramOut, profilePath, iwramLimit);
+    return 0;
+}
+
 int main(int argc, char **argv)
 {
+    if (argc > 1 && std::strcmp(argv[1], "--pack") == 0)
+        return HandlePack(argc, argv);
+
     if (argc < 4)
     {
-        fprintf(stderr, "Usage: %s SECTION_NAME SYM_FILE LANG [-c SRC_PATH,COMMON_SYM_PATH]", argv[0]);
+        fprintf(stderr, "Usage: %s SECTION_NAME SYM_FILE LANG [-c SRC_PATH,COMMON_SYM_PATH] [--cache CACHE_FILE]", argv[0]);
         return 1;
     }
 
@@ -155,17 +203,27 @@ int main(int argc, char **argv)
     std::string sourcePath;
     std::string commonSymPath;
     std::string libSourcePath;
+    std::string cachePath;
 
-    if (argc > 4)
+    for (int i = 4; i < argc; i++)
     {
-        if (std::strcmp(argv[4], "-c") != 0)
-            FATAL_ERROR("error: unrecognized argument \"%s\"\n", argv[4]);
+        if (std::strcmp(argv[i], "--cache") == 0)
+        {
+            if (i + 1 >= argc)
+                FATAL_ERROR("error: missing CACHE_FILE after \"--cache\"\n");
+
+            cachePath = std::string(argv[++i]);
+            continue;
+        }
+
+        if (std::strcmp(argv[i], "-c") != 0)
+            FATAL_ERROR("error: unrecognized argument \"%s\"\n", argv[i]);
 
-        if (argc < 6)
+        if (i + 1 >= argc)
             FATAL_ERROR("error: missing SRC_PATH,COMMON_SYM_PATH after \"-c\"\n");
 
         common = true;
-        std::string paths = std::string(argv[5]);
+        std::string paths = std::string(argv[++i]);
         std::size_t commaPos = paths.find(',');
 
         if (commaPos == std::string::npos)
@@ -182,6 +240,13 @@ int main(int argc, char **argv)
         }
     }
 
+    if (common && !cachePath.empty())
+        LoadCommonSymbolCache(cachePath);
+
     ConvertSymFile(symFileName, sectionName, lang, common, sourcePath, commonSymPath, libSourcePath);
+
+    if (common)
+        SaveCommonSymbolCache();
+
     return 0;
 }
@@ -0,0 +1,195 @@
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+#include "ramscrgen.h"
+#include "elf.h"
+#include "pack.h"
+
+// Layout packer for non-matching builds. Objects must be compiled with
+// -fdata-sections so that every zero-initialized variable lives in its own
+// .bss.<name> section; the linker can then place them one by one.
+
+struct PackItem
+{
+    std::string object;
+    std::string section;
+    std::string symbol;
+    std::uint32_t size;
+    std::uint32_t alignment;
+    unsigned long heat;
+};
+
+struct LayoutStats
+{
+    std::uint32_t bytes;
+    std::uint32_t padding;
+};
+
+static std::uint32_t AlignUp(std::uint32_t value, std::uint32_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// Walks the items as the linker would, starting from an address aligned to
+// the largest alignment in use.
+static LayoutStats Layout(const std::vector<PackItem>& items)
+{
+    LayoutStats stats = { 0, 0 };
+
+    for (const PackItem& item : items)
+    {
+        std::uint32_t aligned = AlignUp(stats.bytes, item.alignment);
+        stats.padding += aligned - stats.bytes;
+        stats.bytes = aligned + item.size;
+    }
+
+    return stats;
+}
+
+// Reads "symbol count" pairs, one per line. Lines starting with '#' are ignored.
+static std::map<std::string, unsigned long> ReadProfile(std::string path)
+{
+    std::map<std::string, unsigned long> profile;
+    FILE* fp = std::fopen(path.c_str(), "r");
+
+    if (fp == NULL)
+        FATAL_ERROR("error: failed to open \"%s\" for reading\n", path.c_str());
+
+    char line[kMaxPath * 2];
+    int lineNum = 0;
+
+    while (std::fgets(line, sizeof(line), fp) != NULL)
+    {
+        char symbol[kMaxPath];
+        unsigned long count;
+
+        lineNum++;
+
+        if (line[0] == '#' || line[std::strspn(line, " \t\r\n")] == 0)
+            continue;
+
+        if (std::sscanf(line, "%255s %lu", symbol, &count) != 2)
+            FATAL_ERROR("%s:%d: error: expected \"symbol count\"\n", path.c_str(), lineNum);
+
+        profile[symbol] += count;
+    }
+
+    std::fclose(fp);
+    return profile;
+}
+
+// Orders a region so that the most strictly aligned sections come first, and
+// within an alignment class the ones whose size is a multiple of the alignment
+// come before the rest. This leaves padding only where a class ends on an odd size.
+static void SortByAlignment(std::vector<PackItem>& items)
+{
+    std::stable_sort(items.begin(), items.end(), [](const PackItem& a, const PackItem& b) {
+        if (a.alignment != b.alignment)
+            return a.alignment > b.alignment;
+        bool aFits = (a.size % a.alignment) == 0;
+        bool bFits = (b.size % b.alignment) == 0;
+        if (aFits != bFits)
+            return aFits;
+        return a.size > b.size;
+    });
+}
+
+static void WriteFragment(std::string path, const std::vector<PackItem>& items)
+{
+    FILE* fp = std::fopen(path.c_str(), "w");
+
+    if (fp == NULL)
+        FATAL_ERROR("error: failed to open \"%s\" for writing\n", path.c_str());
+
+    for (const PackItem& item : items)
+        std::fprintf(fp, "%s(%s);\n", item.object.c_str(), item.section.c_str());
+
+    std::fclose(fp);
+}
+
+static void ReportRegion(const char* name, const std::vector<PackItem>& items)
+{
+    LayoutStats stats = Layout(items);
+    std::fprintf(stderr, "  %-6s %5lu symbols %7lu bytes %5lu bytes padding\n",
+        name, (unsigned long)items.size(), (unsigned long)stats.bytes, (unsigned long)stats.padding);
+}
+
+void PackRam(std::string baseDir, std::vector<std::string> objects, std::string iwramOut, std::string ewramOut, std::string profilePath, unsigned long iwramLimit)
+{
+    std::map<std::string, unsigned long> profile;
+
+    if (!profilePath.empty())
+        profile = ReadProfile(profilePath);
+
+    std::vector<PackItem> items;
+
+    for (const std::string& object : objects)
+    {
+        for (const BssSection& section : GetBssSections(baseDir + "/" + object))
+        {
+            // m4a keeps code in .bss.code, which the linker script places explicitly.
+            if (section.name == ".bss.code")
+                continue;
+
+            if (section.alignment & (section.alignment - 1))
+                FATAL_ERROR("error: section \"%s\" in \"%s\" has non-power-of-2 alignment %u\n",
+                    section.name.c_str(), object.c_str(), section.alignment);
+
+            PackItem item;
+            item.object = object;
+            item.section = section.name;
+            item.symbol = section.name.substr(5);
+            item.size = section.size;
+            item.alignment = section.alignment;
+            item.heat = profile.count(item.symbol) ? profile[item.symbol] : 0;
+            items.push_back(item);
+        }
+    }
+
+    LayoutStats before = Layout(items);
+
+    // Hottest symbols claim IWRAM first. Among equally hot ones, the smallest go
+    // first, so that when the limit is hit it's the big cold buffers that spill.
+    std::vector<PackItem> byHeat = items;
+    std::stable_sort(byHeat.begin(), byHeat.end(), [](const PackItem& a, const PackItem& b) {
+        if (a.heat != b.heat)
+            return a.heat > b.heat;
+        return a.size < b.size;
+    });
+
+    std::vector<PackItem> iwram;
+    std::vector<PackItem> ewram;
+    unsigned long iwramUsed = 0;
+
+    for (const PackItem& item : byHeat)
+    {
+        unsigned long cost = AlignUp(item.size, item.alignment);
+
+        if (iwramLimit == 0 || iwramUsed + cost <= iwramLimit)
+        {
+            iwram.push_back(item);
+            iwramUsed += cost;
+        }
+        else
+        {
+            ewram.push_back(item);
+        }
+    }
+
+    SortByAlignment(iwram);
+    SortByAlignment(ewram);
+
+    WriteFragment(iwramOut, iwram);
+    WriteFragment(ewramOut, ewram);
+
+    std::fprintf(stderr, "ramscrgen: packed %lu .bss sections from %lu objects\n",
+        (unsigned long)items.size(), (unsigned long)objects.size());
+    std::fprintf(stderr, "  before %5lu symbols %7lu bytes %5lu bytes padding\n",
+        (unsigned long)items.size(), (unsigned long)before.bytes, (unsigned long)before.padding);
+    ReportRegion("iwram", iwram);
+    ReportRegion("ewram", ewram);
+}
@@ -0,0 +1,9 @@
+#ifndef PACK_H
+#define PACK_H
+
+#include <string>
+#include <vector>
+
+void PackRam(std::string baseDir, std::vector<std::string> objects, std::string iwramOut, std::string ewramOut, std::string profilePath, unsigned long iwramLimit);
+
+#endif // PACK_H
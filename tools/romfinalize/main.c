@@ -0,0 +1,256 @@
+// Post-link ROM finalizer. Does the work of "xorencrypt" followed by
+// "gbafix -p" in a single pass over a mapped image of the ROM:
+//   1. XOR-encrypts [start_address, end_address) with the release key,
+//   2. restores the fixed header fields and recomputes the header complement,
+//   3. pads the ROM with 0xFF up to the next power of 2.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _MSC_VER
+
+#define FATAL_ERROR(format, ...)           \
+do                                         \
+{                                          \
+    fprintf(stderr, format, __VA_ARGS__);  \
+    exit(1);                               \
+} while (0)
+
+#else
+
+#define FATAL_ERROR(format, ...)            \
+do                                          \
+{                                           \
+    fprintf(stderr, format, ##__VA_ARGS__); \
+    exit(1);                                \
+} while (0)
+
+#endif // _MSC_VER
+
+#define HEADER_SIZE 0xC0
+
+// Offsets into the cartridge header.
+#define HEADER_LOGO        0x04
+#define HEADER_FIXED       0xB2
+#define HEADER_DEVICE_TYPE 0xB4
+#define HEADER_COMPLEMENT  0xBD
+#define HEADER_CHECKSUM    0xBE
+
+static const uint8_t sNintendoLogo[0xA0 - 0x04] = {
+	0x24,0xFF,0xAE,0x51,0x69,0x9A,0xA2,0x21,0x3D,0x84,0x82,0x0A,0x84,0xE4,0x09,0xAD,
+	0x11,0x24,0x8B,0x98,0xC0,0x81,0x7F,0x21,0xA3,0x52,0xBE,0x19,0x93,0x09,0xCE,0x20,
+	0x10,0x46,0x4A,0x4A,0xF8,0x27,0x31,0xEC,0x58,0xC7,0xE8,0x33,0x82,0xE3,0xCE,0xBF,
+	0x85,0xF4,0xDF,0x94,0xCE,0x4B,0x09,0xC1,0x94,0x56,0x8A,0xC0,0x13,0x72,0xA7,0xFC,
+	0x9F,0x84,0x4D,0x73,0xA3,0xCA,0x9A,0x61,0x58,0x97,0xA3,0x27,0xFC,0x03,0x98,0x76,
+	0x23,0x1D,0xC7,0x61,0x03,0x04,0xAE,0x56,0xBF,0x38,0x84,0x00,0x40,0xA7,0x0E,0xFD,
+	0xFF,0x52,0xFE,0x03,0x6F,0x95,0x30,0xF1,0x97,0xFB,0xC0,0x85,0x60,0xD6,0x80,0x25,
+	0xA9,0x63,0xBE,0x03,0x01,0x4E,0x38,0xE2,0xF9,0xA2,0x34,0xFF,0xBB,0x3E,0x03,0x44,
+	0x78,0x00,0x90,0xCB,0x88,0x11,0x3A,0x94,0x65,0xC0,0x7C,0x63,0x87,0xF0,0x3C,0xAF,
+	0xD6,0x25,0xE4,0x8B,0x38,0x0A,0xAC,0x72,0x21,0xD4,0xF8,0x07,
+};
+
+struct RomImage {
+	uint8_t *data;
+	unsigned long file_size;
+	unsigned long size;
+#ifndef _WIN32
+	int fd;
+#else
+	FILE *file;
+#endif
+};
+
+// Opens the ROM read/write without touching it yet. Sets file_size.
+void open_rom(const char *filename, struct RomImage *rom)
+{
+#ifndef _WIN32
+	rom->fd = open(filename, O_RDWR);
+	if (rom->fd < 0)
+		FATAL_ERROR("Failed to open '%s' for reading!\n", filename);
+
+	struct stat st;
+	if (fstat(rom->fd, &st) != 0)
+		FATAL_ERROR("Failed to stat '%s'!\n", filename);
+
+	rom->file_size = st.st_size;
+#else
+	rom->file = fopen(filename, "r+b");
+	if (!rom->file)
+		FATAL_ERROR("Failed to open '%s' for reading!\n", filename);
+
+	fseek(rom->file, 0, SEEK_END);
+	rom->file_size = ftell(rom->file);
+#endif
+	if (rom->file_size < HEADER_SIZE)
+		FATAL_ERROR("'%s' is too small to be a ROM!\n", filename);
+}
+
+// Maps the opened ROM read/write, grown to padded_size bytes of 0xFF.
+// This is the first point at which the file is modified.
+void map_rom(const char *filename, struct RomImage *rom, unsigned long padded_size)
+{
+	rom->size = padded_size;
+#ifndef _WIN32
+	if (rom->size != rom->file_size && ftruncate(rom->fd, rom->size) != 0)
+		FATAL_ERROR("Failed to pad '%s'!\n", filename);
+
+	void *data = mmap(NULL, rom->size, PROT_READ | PROT_WRITE, MAP_SHARED, rom->fd, 0);
+	if (data == MAP_FAILED)
+		FATAL_ERROR("Failed to map '%s'!\n", filename);
+
+	rom->data = data;
+#else
+	rom->data = malloc(rom->size);
+	fseek(rom->file, 0, SEEK_SET);
+	if (fread(rom->data, rom->file_size, 1, rom->file) != 1)
+		FATAL_ERROR("Failed to read bytes from '%s'!\n", filename);
+#endif
+	memset(rom->data + rom->file_size, 0xFF, rom->size - rom->file_size);
+}
+
+void close_rom(const char *filename, struct RomImage *rom)
+{
+#ifndef _WIN32
+	if (munmap(rom->data, rom->size) != 0)
+		FATAL_ERROR("Failed to write '%s'!\n", filename);
+	close(rom->fd);
+#else
+	fseek(rom->file, 0, SEEK_SET);
+	if (fwrite(rom->data, rom->size, 1, rom->file) != 1)
+		FATAL_ERROR("Failed to write '%s'!\n", filename);
+	fclose(rom->file);
+	free(rom->data);
+#endif
+}
+
+// Rounds up to the next exact power of 2, like "gbafix -p".
+unsigned long get_pow2_size(unsigned long size)
+{
+	unsigned long padded = 1;
+	while (padded < size)
+		padded <<= 1;
+	return padded;
+}
+
+// XORs data[start, end) with the little-endian key, where byte i of the range
+// uses key byte (i % 4). The bulk is done 8 bytes at a time with a pattern
+// rotated to match the phase at the first aligned address, which compilers
+// turn into vector XORs.
+void xor_encrypt(uint8_t *data, unsigned long start, unsigned long end, uint32_t key)
+{
+	uint8_t key_bytes[4] = { key & 0xFF, (key >> 8) & 0xFF, (key >> 16) & 0xFF, (key >> 24) & 0xFF };
+	unsigned long i = start;
+
+	while (i < end && (i & 7) != 0)
+	{
+		data[i] ^= key_bytes[(i - start) % 4];
+		i++;
+	}
+
+	uint8_t pattern_bytes[8];
+	for (int j = 0; j < 8; j++)
+		pattern_bytes[j] = key_bytes[(i - start + j) % 4];
+
+	uint64_t pattern;
+	memcpy(&pattern, pattern_bytes, sizeof(pattern));
+
+	for (; i + 8 <= end; i += 8)
+	{
+		uint64_t word;
+		memcpy(&word, data + i, sizeof(word));
+		word ^= pattern;
+		memcpy(data + i, &word, sizeof(word));
+	}
+
+	for (; i < end; i++)
+		data[i] ^= key_bytes[(i - start) % 4];
+}
+
+// Restores the fields that must hold fixed values and recomputes the complement
+// over 0xA0-0xBC. The checksum field must stay 0.
+void fix_header(uint8_t *header)
+{
+	memcpy(header + HEADER_LOGO, sNintendoLogo, sizeof(sNintendoLogo));
+	header[HEADER_FIXED] = 0x96;
+	header[HEADER_DEVICE_TYPE] = 0x00;
+	header[HEADER_COMPLEMENT] = 0;
+	header[HEADER_CHECKSUM] = 0;
+	header[HEADER_CHECKSUM + 1] = 0;
+
+	uint8_t c = 0;
+	for (int n = 0xA0; n < HEADER_COMPLEMENT; n++)
+		c += header[n];
+	header[HEADER_COMPLEMENT] = -(0x19 + c);
+}
+
+void usage(void)
+{
+	fprintf(stderr, "Usage: romfinalize rom_file [-p] [--encrypt start_address end_address encrypt_key]\n");
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 2)
+	{
+		usage();
+		exit(1);
+	}
+
+	char *rom_filepath = argv[1];
+	bool pad = false;
+	bool encrypt = false;
+	unsigned long start_addr = 0, end_addr = 0, encryption_key = 0;
+
+	for (int i = 2; i < argc; i++)
+	{
+		if (strcmp(argv[i], "-p") == 0)
+		{
+			pad = true;
+		}
+		else if (strcmp(argv[i], "--encrypt") == 0 && i + 3 < argc)
+		{
+			encrypt = true;
+			start_addr = strtoul(argv[++i], NULL, 0);
+			end_addr = strtoul(argv[++i], NULL, 0);
+			encryption_key = strtoul(argv[++i], NULL, 0);
+		}
+		else
+		{
+			usage();
+			exit(1);
+		}
+	}
+
+	if (end_addr < start_addr)
+		FATAL_ERROR("end_addr must be greater than or equal to start_addr!\n");
+
+	struct RomImage rom;
+	open_rom(rom_filepath, &rom);
+
+	// Everything is checked before the ROM is padded, so a bad invocation
+	// leaves the file as it was.
+	unsigned long padded_size = pad ? get_pow2_size(rom.file_size) : rom.file_size;
+	if (encrypt && end_addr > padded_size)
+		FATAL_ERROR("Encrypted range 0x%lX-0x%lX is outside of '%s'!\n", start_addr, end_addr, rom_filepath);
+
+	map_rom(rom_filepath, &rom, padded_size);
+
+	if (encrypt)
+		xor_encrypt(rom.data, start_addr, end_addr, encryption_key);
+
+	fix_header(rom.data);
+	close_rom(rom_filepath, &rom);
+	return 0;
+}